@@ -1,13 +1,13 @@
 #include "marian.h"
 
 #include "training/graph_group_async.h"
+#include "training/graph_group_async_drop.h"
 #include "training/graph_group_multinode_sync.h"
 #include "training/graph_group_singleton.h"
 #include "training/graph_group_sync.h"
 #include "training/training.h"
 
 #ifdef CUDA_FOUND
-#include "training/graph_group_async_drop.h"
 #include "training/graph_group_multinode.h"
 #endif
 
@@ -53,12 +53,8 @@ int main(int argc, char** argv) {
       New<Train<SingletonGraph>>(options)->run();
     } else {
       if(options->get<float>("grad-dropping-rate") > 0.0) {
-#ifdef CUDA_FOUND
         LOG(info, "Using asynchronous training with gradient dropping");
         New<Train<AsyncGraphGroupDrop>>(options)->run();
-#else
-        ABORT("Asynchronous training with gradient dropping requires CUDA");
-#endif
       } else {
         LOG(info, "Using asynchronous training");
         New<Train<AsyncGraphGroup>>(options)->run();
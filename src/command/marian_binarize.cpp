@@ -0,0 +1,64 @@
+#include "marian.h"
+
+#include "common/cli_wrapper.h"
+#include "common/logging.h"
+#include "data/corpus_binary.h"
+#include "data/vocab.h"
+
+int main(int argc, char** argv) {
+  using namespace marian;
+
+  createLoggers();
+
+  auto options = New<Options>();
+  {
+    auto cli = New<cli::CLIWrapper>(
+        options,
+        "Encode training corpora with vocabularies into a binary corpus for marian --binary-corpus",
+        "Allowed options",
+        "Examples:\n"
+        "  ./marian-binarize -t corpus.src corpus.trg -v vocab.src.yml vocab.trg.yml -o corpus.bin\n"
+        "  ./marian --binary-corpus corpus.bin -t corpus.src corpus.trg -v vocab.src.yml vocab.trg.yml");
+    cli->add<std::vector<std::string>>("--train-sets,-t",
+        "Paths to training corpora: source target");
+    cli->add<std::vector<std::string>>("--vocabs,-v",
+        "Paths to vocabulary files have to correspond to --train-sets");
+    cli->add<std::vector<int>>("--dim-vocabs",
+        "Maximum items in vocabulary ordered by rank, 0 uses all items in the provided vocabulary file",
+        std::vector<int>({0, 0}));
+    cli->add<std::string>("--guided-alignment",
+        "Path to a file with word alignments to be stored with the corpus");
+    cli->add<std::string>("--data-weighting",
+        "Path to a file with sentence or word weights to be stored with the corpus");
+    cli->add<std::string>("--output,-o", "Output binary corpus", "corpus.bin");
+    cli->parse(argc, argv);
+  }
+
+  auto paths = options->get<std::vector<std::string>>("train-sets");
+  auto vocabPaths = options->get<std::vector<std::string>>("vocabs");
+  ABORT_IF(paths.empty() || paths.size() != vocabPaths.size(),
+           "Number of corpus files and vocab files does not agree");
+
+  auto maxVocabs = options->get<std::vector<int>>("dim-vocabs");
+  if(maxVocabs.size() < vocabPaths.size())
+    maxVocabs.resize(vocabPaths.size(), 0);
+
+  std::vector<Ptr<Vocab>> vocabs;
+  for(size_t i = 0; i < vocabPaths.size(); ++i) {
+    auto vocab = New<Vocab>(options, i);
+    vocab->load(vocabPaths[i], maxVocabs[i]);
+    vocabs.push_back(vocab);
+  }
+
+  LOG(info, "Creating binary corpus...");
+
+  data::CorpusBinary::binarize(paths,
+                               vocabs,
+                               options->get<std::string>("guided-alignment"),
+                               options->get<std::string>("data-weighting"),
+                               options->get<std::string>("output"));
+
+  LOG(info, "Finished");
+
+  return 0;
+}
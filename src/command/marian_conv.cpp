@@ -1,6 +1,7 @@
 #include "marian.h"
 
 #include "common/cli_wrapper.h"
+#include "tensors/cpu/bf16.h"
 
 #include <sstream>
 
@@ -19,10 +20,16 @@ int main(int argc, char** argv) {
         "  ./marian-conv -f model.npz -t model.bin");
     cli->add<std::string>("--from,-f", "Input model", "model.npz");
     cli->add<std::string>("--to,-t", "Output model", "model.bin");
+    cli->add<bool>("--bf16",
+        "Store weight matrices as bfloat16 for CPU inference. Embeddings and output layer stay "
+        "float32");
     cli->parse(argc, argv);
   }
   auto modelFrom = options->get<std::string>("from");
   auto modelTo = options->get<std::string>("to");
+  bool bf16 = options->get<bool>("bf16");
+
+  ABORT_IF(bf16 && !io::isBin(modelTo), "bfloat16 weights can only be stored in *.bin models");
 
   LOG(info, "Outputting {}", modelTo);
 
@@ -36,7 +43,47 @@ int main(int argc, char** argv) {
 
   graph->load(modelFrom);
   graph->forward();
-  graph->save(modelTo, configStr.str());
+
+  std::vector<io::Item> items;
+  graph->save(items);
+
+  if(bf16) {
+    // Converted matrices can only be read by dot() and affine(), see ExpressionGraph::add(). This
+    // holds for the transformer, but RNN cells concatenate their weight matrices, the output layer
+    // of the other models is sliced by shortlists, and ULR embeddings are looked up by rows.
+    auto get = [&](const std::string& key, const std::string& defaultValue) {
+      return config[key] ? config[key].as<std::string>() : defaultValue;
+    };
+    ABORT_IF(get("type", "") != "transformer"
+                 || get("transformer-decoder-autoreg", "self-attention") == "rnn"
+                 || get("ulr", "false") == "true",
+             "--bf16 is only supported for transformer models without RNN decoder layers or ULR "
+             "embeddings");
+
+    // Only matrices that are used as right operands of products can be converted, which excludes
+    // embeddings (looked up by rows) and the output layer (sliced by shortlists).
+    size_t converted = 0;
+    for(auto& item : items) {
+      bool isMatrix = item.shape.size() == 2 && item.shape[0] > 1 && item.shape[1] > 1;
+      if(item.type != Type::float32 || !isMatrix
+         || item.name.find("Wemb") != std::string::npos
+         || item.name.find("ff_logit_out") != std::string::npos)
+        continue;
+
+      const float* in = (const float*)item.bytes.data();
+      std::vector<char> bytes(item.bytes.size() / 2); // keeps padding, halved
+      uint16_t* out = (uint16_t*)bytes.data();
+      for(size_t i = 0; i < bytes.size() / sizeof(uint16_t); ++i)
+        out[i] = cpu::bf16::fromFloat(in[i]);
+      item.bytes.swap(bytes);
+      item.type = Type::bfloat16;
+      converted++;
+    }
+    LOG(info, "Converted {} weight matrices to bfloat16", converted);
+  }
+
+  io::addMetaToItems(configStr.str(), "special:model.yml", items);
+  io::saveItems(modelTo, items);
 
   // graph->saveBinary(vm["bin"].as<std::string>());
 
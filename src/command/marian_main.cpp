@@ -16,6 +16,9 @@
 #define main mainConv
 #include "marian_conv.cpp"
 #undef main
+#define main mainBinarize
+#include "marian_binarize.cpp"
+#undef main
 
 #include "3rd_party/ExceptionWithCallStack.h"
 
@@ -32,7 +35,8 @@ int main(int argc, char** argv) {
     // else if (cmd == "score")     return mainScorer(argc, argv);
     else if (cmd == "vocab")     return mainVocab(argc, argv);
     else if (cmd == "convert")   return mainConv(argc, argv);
-    std::cerr << "Command must be train, decode, score, vocab, or convert." << std::endl;
+    else if (cmd == "binarize")  return mainBinarize(argc, argv);
+    std::cerr << "Command must be train, decode, score, vocab, convert, or binarize." << std::endl;
     exit(1);
   } else
     return mainTrainer(argc, argv);
@@ -38,6 +38,7 @@ const std::set<std::string> PATHS = {
   "output",           // except: stdout
   "pretrained-model",
   "data-weighting",
+  "binary-corpus",
   "log"
   // TODO: Handle the special value in helper functions
   //"sqlite",         // except: temporary
@@ -233,6 +234,10 @@ void ConfigParser::addOptionsModel(cli::CLIWrapper& cli) {
         "Dropout for transformer attention (0 = no dropout)");
     cli.add<float>("--transformer-dropout-ffn",
         "Dropout for transformer filter (0 = no dropout)");
+    cli.add<bool>("--transformer-checkpointing",
+        "Free activations inside transformer layers after the forward step and recompute them "
+        "in the backward step. Saves memory for larger batches at the cost of about one more "
+        "forward step");
   }
   // clang-format on
 }
@@ -245,6 +250,9 @@ void ConfigParser::addOptionsTraining(cli::CLIWrapper& cli) {
   cli.add<bool>("--overwrite",
       "Do not create model checkpoints, only overwrite main model file with last checkpoint. "
       "Reduces disk usage");
+  cli.add<bool>("--async-save",
+      "Write model checkpoints and optimizer state on a background thread while training "
+      "continues (only with --sync-sgd)");
   cli.add<bool>("--no-reload",
       "Do not load existing model specified in --model arg");
   cli.add<std::vector<std::string>>("--train-sets,-t",
@@ -290,12 +298,19 @@ void ConfigParser::addOptionsTraining(cli::CLIWrapper& cli) {
   cli.add<std::string>("--tempdir,-T",
       "Directory for temporary (shuffled) files and database",
       "/tmp");
+  cli.add<size_t>("--shuffle-memory",
+      "Shuffle the corpus out-of-core in compressed temporary files, keeping at most  arg  MB of text in RAM. "
+      "0 reads the whole corpus into RAM for shuffling",
+      0);
   cli.add<std::string>("--sqlite",
       "Use disk-based sqlite3 database for training corpus storage, default"
       " is temporary with path creates persistent storage")
     ->implicit_val("temporary");
   cli.add<bool>("--sqlite-drop",
       "Drop existing tables in sqlite3 database");
+  cli.add<std::string>("--binary-corpus",
+      "Read the training corpus from a binary file created by marian-binarize"
+      " from --train-sets, --vocabs, --guided-alignment and --data-weighting");
 
   addSuboptionsDevices(cli);
   addSuboptionsBatching(cli);
@@ -312,6 +327,14 @@ void ConfigParser::addOptionsTraining(cli::CLIWrapper& cli) {
 
   cli.add<bool>("--sync-sgd",
      "Use synchronous SGD instead of asynchronous for multi-gpu training");
+  cli.add<size_t>("--gradient-bucket-size",
+      "Reduce gradients in buckets of this many MB while the backward step is still running, "
+      "0 to reduce all gradients afterwards. Only for --sync-sgd on several CPU workers",
+      0);
+  cli.add<std::string>("--async-shard-sync",
+      "Synchronization of parameter shards in asynchronous training: mutex, seqlock (readers "
+      "copy versioned snapshots without locking), hogwild (readers copy without any checks)",
+      "mutex");
 
   // learning rate options
   cli.add<double>("--learn-rate,-l",
@@ -357,6 +380,9 @@ void ConfigParser::addOptionsTraining(cli::CLIWrapper& cli) {
   cli.add<float>("--exponential-smoothing",
      "Maintain smoothed version of parameters for validation and saving with smoothing factor. 0 to disable",
      0)->implicit_val("1e-4");
+  cli.add<bool>("--exponential-smoothing-fused",
+     "Update smoothed parameters in the same pass over memory as the optimizer step instead of "
+     "in a separate one (fused on CPU only)");
   cli.add<std::string>("--guided-alignment",
      "Path to a file with word alignments. Use guided alignment to guide attention or 'none'",
      "none");
@@ -581,6 +607,11 @@ void ConfigParser::addSuboptionsBatching(cli::CLIWrapper& cli) {
                defaultMiniBatch);
   cli.add<int>("--mini-batch-words",
       "Set mini-batch size based on words instead of sentences");
+  if(mode_ == cli::mode::translation) {
+    cli.add<size_t>("--mini-batch-tokens",
+      "Set mini-batch size based on a budget of search states: sentences x beam size x "
+      "longest source sentence x max length factor");
+  }
 
   if(mode_ == cli::mode::training) {
     cli.add<bool>("--mini-batch-fit",
@@ -588,6 +619,12 @@ void ConfigParser::addSuboptionsBatching(cli::CLIWrapper& cli) {
     cli.add<size_t>("--mini-batch-fit-step",
       "Step size for mini-batch-fit statistics",
       10);
+    cli.add<bool>("--mini-batch-fit-cache",
+      "Save mini-batch-fit statistics next to the model and reuse them on restarts with the same "
+      "model shape, workspace and devices");
+    cli.add<bool>("--mini-batch-fit-extrapolate",
+      "Search mini-batch-fit statistics only for three sentence lengths and extrapolate "
+      "with a quadratic memory model, verifying each extrapolated batch size");
   }
 
   cli.add<int>("--maxi-batch",
@@ -596,9 +633,18 @@ void ConfigParser::addSuboptionsBatching(cli::CLIWrapper& cli) {
   cli.add<std::string>("--maxi-batch-sort",
       "Sorting strategy for maxi-batch: none, src, trg (not available for decoder)",
       defaultMaxiBatchSort);
+  cli.add<size_t>("--maxi-batch-prefetch",
+      "Number of maxi-batches read, sorted and split into batches ahead of time on background "
+      "threads",
+      1);
 
   cli.add<bool>("--shuffle-in-ram",
       "Keep shuffled corpus in RAM, do not write to temp file");
+  if(mode_ != cli::mode::translation) {
+    cli.add<size_t>("--data-threads",
+      "Number of threads encoding sentences read from the corpus in parallel chunks",
+      1);
+  }
   // clang-format on
 }
 
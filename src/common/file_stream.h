@@ -8,8 +8,13 @@
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 
+#include <condition_variable>
+#include <exception>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 #ifdef _MSC_VER
 #include <fcntl.h>
@@ -125,25 +130,143 @@ public:
   std::string getFileName() { return name_; }
 };
 
+// Stream buffer that reads from another stream buffer on a background thread into a ring
+// of large buffers, so that e.g. gzip decompression runs concurrently with the consumer's
+// line parsing. Errors of the source are rethrown on the consumer side.
+class ReadAheadBuffer : public std::streambuf {
+public:
+  ReadAheadBuffer(std::streambuf* source, size_t bufferSize = 1 << 22, size_t numBuffers = 4)
+      : source_(source), bufferSize_(bufferSize), buffers_(numBuffers), sizes_(numBuffers, 0) {
+    for(size_t i = 0; i < numBuffers; ++i) {
+      buffers_[i].reset(new char[bufferSize_]);
+      free_.push(i);
+    }
+    thread_ = std::thread([this]() { fill(); });
+  }
+
+  ~ReadAheadBuffer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    freeCond_.notify_all();
+    thread_.join();
+  }
+
+protected:
+  int_type underflow() override {
+    if(gptr() < egptr())
+      return traits_type::to_int_type(*gptr());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // hand the consumed buffer back to the reading thread
+    if(current_ < buffers_.size()) {
+      free_.push(current_);
+      current_ = buffers_.size();
+      freeCond_.notify_one();
+    }
+
+    fullCond_.wait(lock, [this]() { return !full_.empty() || done_; });
+    if(full_.empty()) {
+      setg(nullptr, nullptr, nullptr);
+      if(error_)
+        std::rethrow_exception(error_);
+      return traits_type::eof();
+    }
+
+    current_ = full_.front();
+    full_.pop();
+    char* data = buffers_[current_].get();
+    setg(data, data, data + sizes_[current_]);
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  void fill() {
+    for(;;) {
+      size_t idx;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        freeCond_.wait(lock, [this]() { return !free_.empty() || stop_; });
+        if(stop_)
+          return;
+        idx = free_.front();
+        free_.pop();
+      }
+
+      std::streamsize size = 0;
+      std::exception_ptr error;
+      try {
+        size = source_->sgetn(buffers_[idx].get(), (std::streamsize)bufferSize_);
+      } catch(...) {
+        error = std::current_exception();
+      }
+
+      bool finished;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(size > 0) {
+          sizes_[idx] = (size_t)size;
+          full_.push(idx);
+        }
+        // sgetn() only returns less than requested at the end of the source
+        if(error || size < (std::streamsize)bufferSize_) {
+          error_ = error;
+          done_ = true;
+        }
+        finished = done_;
+      }
+      fullCond_.notify_one();
+      if(finished)
+        return;
+    }
+  }
+
+  std::streambuf* source_;
+  size_t bufferSize_;
+  std::vector<UPtr<char[]>> buffers_;
+  std::vector<size_t> sizes_;
+
+  std::mutex mutex_;
+  std::condition_variable freeCond_;
+  std::condition_variable fullCond_;
+  std::queue<size_t> free_; // buffers to be filled by the reading thread
+  std::queue<size_t> full_; // buffers to be consumed, in order
+  size_t current_{(size_t)-1}; // buffer currently read by the consumer
+  bool done_{false};
+  bool stop_{false};
+  std::exception_ptr error_;
+
+  std::thread thread_;
+};
+
 class InputFileStream {
 public:
   InputFileStream(const std::string& file)
   : file_(file) {
     ABORT_IF(!marian::filesystem::exists(file_), "File '{}' could not be opened", file);
 
-    if(file_.extension() == marian::filesystem::Path(".gz"))
-      istream_.reset(new zstr::ifstream(file_.string()));
+    if(file_.extension() == marian::filesystem::Path(".gz")) {
+      // decompress on a separate thread ahead of the reader
+      source_.reset(new zstr::ifstream(file_.string()));
+      readAhead_.reset(new ReadAheadBuffer(source_->rdbuf()));
+      istream_.reset(new std::istream(readAhead_.get()));
+    }
     else
       istream_.reset(new std::ifstream(file_.string()));
   }
 
-  InputFileStream(TemporaryFile& tempfile)
+  // reads a temporary file from the start, decompressing it if written with gzipped = true
+  InputFileStream(TemporaryFile& tempfile, bool gzipped = false)
       : fds_(tempfile.getFileDescriptor(), boost::iostreams::never_close_handle) {
     lseek(tempfile.getFileDescriptor(), 0, SEEK_SET);
 
     namespace bio = boost::iostreams;
     fdsBuffer_.reset(new bio::stream_buffer<bio::file_descriptor_source>(fds_));
-    istream_.reset(new std::istream(fdsBuffer_.get()));
+    if(gzipped)
+      istream_.reset(new zstr::istream(fdsBuffer_.get()));
+    else
+      istream_.reset(new std::istream(fdsBuffer_.get()));
   }
 
   InputFileStream(std::istream& strm)
@@ -193,6 +316,8 @@ public:
 
 private:
   marian::filesystem::Path file_;
+  std::unique_ptr<std::istream> source_;      // for read-ahead: the actual decompressing stream
+  std::unique_ptr<ReadAheadBuffer> readAhead_;
   std::unique_ptr<std::istream> istream_;
 
   boost::iostreams::file_descriptor_source fds_;
@@ -236,15 +361,22 @@ public:
     ABORT_IF(!marian::filesystem::exists(file_), "File '{}' could not be opened", file);
   }
 
-  OutputFileStream(TemporaryFile& tempfile)
+  // writes a temporary file from the start, compressing it with gzip if gzipped = true
+  OutputFileStream(TemporaryFile& tempfile, bool gzipped = false)
       : fds_(tempfile.getFileDescriptor(), boost::iostreams::never_close_handle) {
     lseek(tempfile.getFileDescriptor(), 0, SEEK_SET);
 
     namespace bio = boost::iostreams;
     fdsBuffer_.reset(new bio::stream_buffer<bio::file_descriptor_sink>(fds_));
-    ostream_.reset(new std::ostream(fdsBuffer_.get()));
+    if(gzipped)
+      ostream_.reset(new zstr::ostream(fdsBuffer_.get()));
+    else
+      ostream_.reset(new std::ostream(fdsBuffer_.get()));
   }
 
+  // the gzip stream flushes into fdsBuffer_ on destruction, so it has to go first
+  ~OutputFileStream() { ostream_.reset(); }
+
   OutputFileStream(std::ostream& strm) {
     ostream_.reset(new std::ostream(strm.rdbuf()));
   }
@@ -0,0 +1 @@
+#define GIT_REVISION "f27c907 2026-10-18 16:29:45 +0000"
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "common/binary.h"
 #include "common/io_item.h"
 
+#include <cstdio>
+
 namespace marian {
 namespace io {
 
@@ -143,15 +145,72 @@ void saveItemsNpz(const std::string& fileName, const std::vector<Item>& items) {
   cnpy::npz_save(fileName, npzItems);
 }
 
-void saveItems(const std::string& fileName, const std::vector<Item>& items) {
+// writer that saveItems() hands its files to, see AsyncWriter::Scope
+static thread_local AsyncWriter* activeWriter = nullptr;
+
+// the format is determined by fileName, the data is written to path
+static void saveItemsAs(const std::string& fileName,
+                        const std::string& path,
+                        const std::vector<Item>& items) {
   if(isNpz(fileName)) {
-    saveItemsNpz(fileName, items);
+    saveItemsNpz(path, items);
   } else if(isBin(fileName)) {
-    binary::saveItems(fileName, items);
+    binary::saveItems(path, items);
   } else {
     ABORT("Unknown file format for file {}", fileName);
   }
 }
 
+void saveItems(const std::string& fileName, const std::vector<Item>& items) {
+  if(!activeWriter) {
+    saveItemsAs(fileName, fileName, items);
+    return;
+  }
+
+  saveItems(fileName, std::vector<Item>(items));
+}
+
+void saveItems(const std::string& fileName, std::vector<Item>&& items) {
+  if(!activeWriter) {
+    saveItemsAs(fileName, fileName, items);
+    return;
+  }
+
+  auto snapshot = std::make_shared<std::vector<Item>>(std::move(items));
+  activeWriter->enqueue([fileName, snapshot]() {
+    std::string tmpName = fileName + ".tmp";
+    saveItemsAs(fileName, tmpName, *snapshot);
+    ABORT_IF(std::rename(tmpName.c_str(), fileName.c_str()) != 0,
+             "Could not rename {} to {}",
+             tmpName,
+             fileName);
+  });
+}
+
+AsyncWriter::AsyncWriter() : pool_(new ThreadPool(1)) {}
+
+AsyncWriter::~AsyncWriter() {
+  wait();
+}
+
+AsyncWriter::Scope::Scope(AsyncWriter& writer) : previous_(activeWriter) {
+  activeWriter = &writer;
+}
+
+AsyncWriter::Scope::~Scope() {
+  activeWriter = previous_;
+}
+
+void AsyncWriter::enqueue(std::function<void()> job) {
+  pending_.emplace_back(pool_->enqueue(job));
+}
+
+void AsyncWriter::wait() {
+  auto pending = std::move(pending_);
+  pending_.clear();
+  for(auto& done : pending)
+    done.get();
+}
+
 }  // namespace io
 }  // namespace marian
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "3rd_party/threadpool.h"
 #include "3rd_party/yaml-cpp/yaml.h"
 #include "common/io_item.h"
 
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,6 +36,40 @@ std::vector<Item> loadItems(const void* ptr);
 std::vector<Item> mmapItems(const void* ptr);
 
 void saveItems(const std::string& fileName, const std::vector<Item>& items);
+// same, but an AsyncWriter job takes over the items instead of copying them
+void saveItems(const std::string& fileName, std::vector<Item>&& items);
+
+/**
+ * Writes checkpoint files on a background thread.
+ *
+ * While an AsyncWriter::Scope is alive, saveItems() on the same thread does not write anything
+ * itself. The items passed to it are already host-side copies. They are moved into a job if they
+ * are passed as an rvalue and copied otherwise. The job writes them to a temporary file and renames
+ * it to the final name once it is complete. Jobs run
+ * in the order they were queued; wait() blocks until all of them are done and rethrows errors.
+ */
+class AsyncWriter {
+public:
+  AsyncWriter();
+  ~AsyncWriter();
+
+  // redirects saveItems() on the current thread to the given writer during its lifetime
+  class Scope {
+  public:
+    Scope(AsyncWriter& writer);
+    ~Scope();
+
+  private:
+    AsyncWriter* previous_;
+  };
+
+  void enqueue(std::function<void()> job);
+  void wait();
+
+private:
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<std::future<void>> pending_;
+};
 
 }  // namespace io
 }  // namespace marian
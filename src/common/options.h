@@ -2,8 +2,10 @@
 
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include "common/definitions.h"
 
+#include "3rd_party/any_type.h"
 #include "3rd_party/yaml-cpp/yaml.h"
 
 #define YAML_REGISTER_TYPE(registered, type)                \
@@ -30,6 +32,7 @@ namespace marian {
 class Options {
 protected:
   YAML::Node options_;
+  size_t version_{0};
 
 public:
   Options() {}
@@ -40,10 +43,22 @@ public:
    */
   Options clone() const { return Options(*this); }
 
-  YAML::Node& getYaml() { return options_; }
+  // Non-const access may modify the options, so it counts as a modification
+  YAML::Node& getYaml() {
+    ++version_;
+    return options_;
+  }
   const YAML::Node& getYaml() const { return options_; }
 
+  /**
+   * @brief Return a counter that changes whenever the options are modified
+   *
+   * Allows to cache values of options, see OptionsCache.
+   */
+  size_t version() const { return version_; }
+
   void parse(const std::string& yaml) {
+    ++version_;
     auto node = YAML::Load(yaml);
     for(auto it : node)
       options_[it.first.as<std::string>()] = YAML::Clone(it.second);
@@ -59,6 +74,7 @@ public:
    * @param overwrite overwrite all options
    */
   void merge(YAML::Node& node, bool overwrite = false) {
+    ++version_;
     for(auto it : node)
       if(overwrite || !options_[it.first.as<std::string>()])
         options_[it.first.as<std::string>()] = YAML::Clone(it.second);
@@ -75,6 +91,7 @@ public:
 
   template <typename T>
   void set(const std::string& key, T value) {
+    ++version_;
     options_[key] = value;
   }
 
@@ -95,4 +112,69 @@ public:
   bool has(const std::string& key) const { return options_[key]; }
 };
 
+/**
+ * Typed values of options resolved once from their YAML representation.
+ *
+ * Options::get() looks up and converts the YAML node on every call, which is noticeable for
+ * options queried per layer and per decoding step. A cache keeps the converted values and
+ * resolves them again only if the options object has been modified or replaced since. The cache
+ * is not thread-safe, every consumer (model, search, ...) should own its cache.
+ */
+class OptionsCache {
+private:
+  struct Entry {
+    bool found{false};
+    any_type value;
+  };
+
+  std::unordered_map<std::string, Entry> entries_;
+  const Options* options_{nullptr};
+  size_t version_{0};
+
+  template <typename T>
+  Entry& resolve(Options& options, const std::string& key) {
+    if(options_ != &options || version_ != options.version()) {
+      entries_.clear();
+      options_ = &options;
+      version_ = options.version();
+    }
+
+    auto it = entries_.find(key);
+    // re-resolve if the same option is requested with a different type
+    if(it != entries_.end() && (!it->second.found || it->second.value.is<T>()))
+      return it->second;
+
+    Entry& entry = entries_[key];
+    entry.found = options.has(key);
+    if(entry.found)
+      entry.value = options.get<T>(key);
+    return entry;
+  }
+
+public:
+  OptionsCache() {}
+  // copies start out empty and resolve their values again
+  OptionsCache(const OptionsCache&) {}
+  OptionsCache& operator=(const OptionsCache&) {
+    clear();
+    options_ = nullptr;
+    return *this;
+  }
+
+  template <typename T>
+  T get(Options& options, const std::string& key) {
+    Entry& entry = resolve<T>(options, key);
+    ABORT_IF(!entry.found, "Required option '{}' has not been set", key);
+    return entry.value.as<T>();
+  }
+
+  template <typename T>
+  T get(Options& options, const std::string& key, const T& defaultValue) {
+    Entry& entry = resolve<T>(options, key);
+    return entry.found ? entry.value.as<T>() : defaultValue;
+  }
+
+  void clear() { entries_.clear(); }
+};
+
 }  // namespace marian
@@ -9,6 +9,7 @@ enum class TypeClass : size_t {
   signed_type = 0x100,
   unsigned_type = 0x200,
   float_type = 0x400,
+  bfloat_type = 0x800 | 0x400, // also a float type
   size_mask = 0x0FF
 };
 
@@ -28,7 +29,9 @@ enum class Type : size_t {
   uint64 = TypeClass::unsigned_type + 8u,
 
   float32 = TypeClass::float_type + 4u,
-  float64 = TypeClass::float_type + 8u
+  float64 = TypeClass::float_type + 8u,
+
+  bfloat16 = TypeClass::bfloat_type + 2u // storage only, for CPU inference, see tensors/cpu/bf16.h
 };
 
 static inline size_t operator&(TypeClass typeClass, Type type) {
@@ -87,6 +90,8 @@ static inline std::ostream& operator<<(std::ostream& out, Type type) {
 
     case Type::float32: out << "float32"; break;
     case Type::float64: out << "float64"; break;
+
+    case Type::bfloat16: out << "bfloat16"; break;
   }
   return out;
 }
@@ -11,7 +11,7 @@
 #include <deque>
 #include <functional>
 #include <mutex>
-#include <queue>
+#include <numeric>
 
 namespace marian {
 namespace data {
@@ -77,51 +77,57 @@ private:
   typename DataSet::iterator current_;
   bool newlyPrepared_{ true }; // prepare() was just called: we need to reset current_  --@TODO: can we just reset it directly?
 
-  // variables for multi-threaded pre-fetching
-  mutable ThreadPool threadPool_; // (we only use one thread, but keep it around)
-  std::future<std::deque<BatchPtr>> futureBufferedBatches_; // next swath of batches is returned via this
-
-  // this runs on a bg thread; sequencing is handled by caller, but locking is done in here
-  std::deque<BatchPtr> fetchBatches() {
-    //LOG(info, "fillBatches entered");
-    typedef typename Sample::value_type Item;
-    auto itemCmp = [](const Item& sa, const Item& sb) { return sa.size() < sb.size(); }; // sort by element length, not content
-
-    auto cmpSrc = [itemCmp](const Sample& a, const Sample& b) {
-      return std::lexicographical_compare(
-          a.begin(), a.end(), b.begin(), b.end(), itemCmp);
-    };
-
-    auto cmpTrg = [itemCmp](const Sample& a, const Sample& b) {
-      return std::lexicographical_compare(
-          a.rbegin(), a.rend(), b.rbegin(), b.rend(), itemCmp);
-    };
-
-    auto cmpNone = [](const Sample& a, const Sample& b) { return &a < &b; }; // instead sort by address, so we have something to work with
-
-    typedef std::function<bool(const Sample&, const Sample&)> cmp_type;
-    typedef std::priority_queue<Sample, Samples, cmp_type> sample_queue;
-
-    std::unique_ptr<sample_queue> maxiBatch; // priority queue, shortest first
-
-    if(options_->has("maxi-batch-sort")) {
-      if(options_->get<std::string>("maxi-batch-sort") == "src")
-        maxiBatch.reset(new sample_queue(cmpSrc));
-      else if(options_->get<std::string>("maxi-batch-sort") == "none")
-        maxiBatch.reset(new sample_queue(cmpNone));
-      else
-        maxiBatch.reset(new sample_queue(cmpTrg));
-    } else {
-      maxiBatch.reset(new sample_queue(cmpNone));
+  // variables for multi-threaded pre-fetching, a two-stage pipeline of one thread each: the
+  // reading thread consumes maxi-batches from the corpus, the batching thread sorts them and
+  // splits them into batches. Both work on up to prefetch_ maxi-batches ahead of next().
+  size_t prefetch_{1};
+  mutable ThreadPool readPool_;
+  mutable ThreadPool batchPool_;
+  std::deque<std::future<std::deque<BatchPtr>>> futureBufferedBatches_; // next swaths of batches, in order
+
+  // Sorts samples by decreasing length, comparing the lengths of the streams in the given
+  // order of significance. This is an LSD radix sort over length buckets: one stable counting
+  // sort per stream, starting with the least significant one, each linear in the number of
+  // samples. Samples of equal lengths keep their relative order, which is randomized first
+  // if shuffleTies is set. Only indices are permuted, every sample is moved once.
+  void sortByLength(Samples& samples, const std::vector<size_t>& streamOrder, bool shuffleTies) {
+    std::vector<size_t> order(samples.size()), sorted(samples.size());
+    std::iota(order.begin(), order.end(), 0);
+    if(shuffleTies)
+      std::shuffle(order.begin(), order.end(), eng_);
+
+    std::vector<size_t> bucketStarts;
+    for(auto it = streamOrder.rbegin(); it != streamOrder.rend(); ++it) {
+      size_t stream = *it;
+      size_t maxLength = 0;
+      for(const auto& sample : samples)
+        maxLength = std::max(maxLength, sample[stream].size());
+
+      // bucket l holds the samples of length maxLength - l, longest first
+      bucketStarts.assign(maxLength + 2, 0);
+      for(const auto& sample : samples)
+        bucketStarts[maxLength - sample[stream].size() + 1]++;
+      std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+
+      for(auto idx : order)
+        sorted[bucketStarts[maxLength - samples[idx][stream].size()]++] = idx;
+      std::swap(order, sorted);
     }
 
+    Samples result;
+    result.reserve(samples.size());
+    for(auto idx : order)
+      result.push_back(std::move(samples[idx]));
+    samples = std::move(result);
+  }
+
+  // this runs on the reading thread; sequencing is handled by the pool, which runs one job at a
+  // time in order
+  Samples readMaxiBatch() {
     size_t maxBatchSize = options_->get<int>("mini-batch");
     size_t maxSize = maxBatchSize * options_->get<int>("maxi-batch");
 
-    // LOG(info, "Preloading batches");
-
     // consume data from corpus into maxi-batch (single sentences)
-    // sorted into specified order (due to queue)
     if(newlyPrepared_) {
       current_ = data_->begin();
       newlyPrepared_ = false;
@@ -129,17 +135,36 @@ private:
       if(current_ != data_->end())
         ++current_;
     }
-    size_t sets = 0;
-    while(current_ != data_->end() && maxiBatch->size() < maxSize) { // loop over data
-      maxiBatch->push(*current_);
-      sets = current_->size();
+    Samples maxiBatch;
+    maxiBatch.reserve(maxSize);
+    while(current_ != data_->end() && maxiBatch.size() < maxSize) { // loop over data
+      maxiBatch.push_back(*current_);
         // do not consume more than required for the maxi batch as this causes
         // that line-by-line translation is delayed by one sentence
-        bool last = maxiBatch->size() == maxSize;
+        bool last = maxiBatch.size() == maxSize;
       if(!last)
         ++current_; // this actually reads the next line and pre-processes it
     }
-    size_t numSentencesRead = maxiBatch->size();
+    return maxiBatch;
+  }
+
+  // this runs on the batching thread, after readMaxiBatch() for the same maxi-batch
+  std::deque<BatchPtr> makeBatches(Samples maxiBatch) {
+    //LOG(info, "fillBatches entered");
+    size_t maxBatchSize = options_->get<int>("mini-batch");
+
+    size_t numSentencesRead = maxiBatch.size();
+    size_t sets = maxiBatch.empty() ? 0 : maxiBatch.back().size();
+
+    // sort into the specified order using length buckets, with random order within a bucket
+    std::string maxiBatchSort = options_->get<std::string>("maxi-batch-sort", "none");
+    if(maxiBatchSort != "none" && sets > 0) {
+      std::vector<size_t> streamOrder(sets);
+      std::iota(streamOrder.begin(), streamOrder.end(), 0);
+      if(maxiBatchSort != "src")
+        std::reverse(streamOrder.begin(), streamOrder.end());
+      sortByLength(maxiBatch, streamOrder, shuffle_);
+    }
 
     // LOG(info, "Turning samples into batches");
 
@@ -150,18 +175,23 @@ private:
 
     std::deque<BatchPtr> tempBatches;
 
-    // process all loaded sentences in order of increasing length
-    // @TODO: we could just use a vector and do a sort() here; would make the cost more explicit
-    //LOG(info, "begin form batches, #lines = {}", maxiBatch->size());
+    // process all loaded sentences in sorted order, longest first
+    //LOG(info, "begin form batches, #lines = {}", maxiBatch.size());
     const size_t mbWords = options_->get<size_t>("mini-batch-words", 0);
     const bool useDynamicBatching = options_->has("mini-batch-fit");
+    // for translation: beam search cost grows with sentences x beam size x target length,
+    // where the target length is bounded by the padded source length times max-length-factor
+    const size_t mbTokens = options_->get<size_t>("mini-batch-tokens", 0);
+    const float tokensPerSourceWord = mbTokens > 0
+        ? options_->get<size_t>("beam-size") * options_->get<float>("max-length-factor")
+        : 0.f;
     BatchStats::const_iterator cachedStatsIter;
     if (stats_)
       cachedStatsIter = stats_->begin();
-    while(!maxiBatch->empty()) { // while there are sentences in the queue
+    size_t next = 0;
+    while(next < maxiBatch.size()) { // while there are sentences left
       // push item onto batch
-      batchVector.push_back(maxiBatch->top());
-      maxiBatch->pop(); // fetch next-shortest
+      batchVector.push_back(std::move(maxiBatch[next++]));
 
       // have we reached sufficient amount of data to form a batch?
       bool makeBatch;
@@ -180,7 +210,17 @@ private:
         makeBatch = batchVector.size() >= maxBatchSize;
         // if last added sentence caused a bump then we likely have bad padding, so rather move it into the next batch
         if(batchVector.size() > maxBatchSize) {
-          maxiBatch->push(batchVector.back());
+          maxiBatch[--next] = std::move(batchVector.back());
+          batchVector.pop_back();
+        }
+      }
+      else if(mbTokens > 0) {
+        lengths[0] = std::max(lengths[0], batchVector.back()[0].size()); // longest source sentence so far
+        float tokens = batchVector.size() * lengths[0] * tokensPerSourceWord;
+        makeBatch = tokens >= mbTokens;
+        // do not exceed the budget with the last sentence unless it is alone in the batch
+        if(tokens > mbTokens && batchVector.size() > 1) {
+          maxiBatch[--next] = std::move(batchVector.back());
           batchVector.pop_back();
         }
       }
@@ -217,22 +257,35 @@ private:
     return tempBatches;
   }
 
-  // this starts fillBatches() as a background operation
+  // this starts reading and batching of the next maxi-batch as background operations
   void fetchBatchesAsync() {
-    ABORT_IF(futureBufferedBatches_.valid(), "attempted to restart futureBufferedBatches_ while still running");
-    futureBufferedBatches_ = threadPool_.enqueue([this]() {
-      return fetchBatches();
-    });
+    auto samples = New<std::future<Samples>>(readPool_.enqueue([this]() {
+      return readMaxiBatch();
+    }));
+    futureBufferedBatches_.push_back(batchPool_.enqueue([this, samples]() {
+      return makeBatches(samples->get());
+    }));
+  }
+
+  // waits for all background operations, e.g. before the corpus is reset
+  void waitForPrefetch() {
+    while(!futureBufferedBatches_.empty()) {
+      futureBufferedBatches_.front().get();
+      futureBufferedBatches_.pop_front();
+    }
   }
 
   BatchPtr next() {
     if(bufferedBatches_.empty()) {
       // out of data: need to get next batch from background thread
       // We only get here if the future has been scheduled to run; it must be valid.
-      ABORT_IF(!futureBufferedBatches_.valid(), "attempted to wait for futureBufferedBatches_ when none pending");
-      bufferedBatches_ = std::move(futureBufferedBatches_.get());
-      // if bg thread returns an empty swath, we hit the end of the epoch
+      ABORT_IF(futureBufferedBatches_.empty(), "attempted to wait for futureBufferedBatches_ when none pending");
+      bufferedBatches_ = std::move(futureBufferedBatches_.front().get());
+      futureBufferedBatches_.pop_front();
+      // if bg thread returns an empty swath, we hit the end of the epoch; maxi-batches that
+      // were fetched further ahead are empty as well
       if (bufferedBatches_.empty()) {
+        waitForPrefetch();
         return nullptr;
       }
       // and kick off the next bg operation
@@ -248,11 +301,15 @@ public:
   BatchGenerator(Ptr<DataSet> data,
                  Ptr<Options> options,
                  Ptr<BatchStats> stats = nullptr)
-      : data_(data), options_(options), stats_(stats), threadPool_(1) {}
+      : data_(data),
+        options_(options),
+        stats_(stats),
+        prefetch_(std::max<size_t>(1, options_->get<size_t>("maxi-batch-prefetch", 1))),
+        readPool_(1),
+        batchPool_(1) {}
 
   ~BatchGenerator() {
-    if (futureBufferedBatches_.valid()) // bg thread holds a reference to 'this',
-      futureBufferedBatches_.get();     // so must wait for it to complete
+    waitForPrefetch(); // bg threads hold a reference to 'this', so must wait for them to complete
   }
 
   iterator begin() {
@@ -265,6 +322,10 @@ public:
 
   // @TODO: get rid of this function, begin() or constructor should figure this out
   void prepare(bool shuffle = true) {
+    // the reading thread must not touch the corpus while it is shuffled or reset
+    waitForPrefetch();
+    bufferedBatches_.clear();
+
     if(shuffle)
       data_->shuffle();
     else
@@ -274,8 +335,9 @@ public:
     // @TODO: solve this better, maybe use options
     shuffle_ = shuffle;
 
-    // start the background pre-fetch operation
-    fetchBatchesAsync();
+    // start the background pre-fetch operations
+    for(size_t i = 0; i < prefetch_; ++i)
+      fetchBatchesAsync();
   }
 
   // Used to restore the state of a BatchGenerator after
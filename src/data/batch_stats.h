@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdio>
 #include <deque>
 #include <queue>
 
+#include "3rd_party/yaml-cpp/yaml.h"
+#include "common/file_stream.h"
+#include "common/filesystem.h"
 #include "data/corpus.h"
 #include "data/vocab.h"
 
@@ -87,6 +91,51 @@ public:
     //dump();
   }
 
+  // saves the statistics with a key that identifies the configuration they were collected for.
+  // The file is written under a temporary name and renamed, so readers never see a partial file.
+  void save(const std::string& path, const std::string& key) const {
+    YAML::Node yaml;
+    yaml["key"] = key;
+    auto flattened = flatten();
+    yaml["size"] = flattened.size();
+    yaml["stats"] = flattened;
+    std::string tmpPath = path + ".tmp";
+    {
+      io::OutputFileStream out(tmpPath);
+      out << yaml;
+    }
+    ABORT_IF(std::rename(tmpPath.c_str(), path.c_str()) != 0,
+             "Could not rename {} to {}",
+             tmpPath,
+             path);
+  }
+
+  // loads statistics written by save(), or returns nullptr if there is no such file, it was
+  // saved for a different key or it cannot be read, in which case the statistics are recomputed
+  static Ptr<BatchStats> load(const std::string& path, const std::string& key) {
+    if(!filesystem::exists(path))
+      return nullptr;
+    std::vector<size_t> flattened;
+    try {
+      YAML::Node yaml = YAML::Load(io::InputFileStream(path));
+      if(!yaml["key"] || yaml["key"].as<std::string>() != key || !yaml["stats"] || !yaml["size"])
+        return nullptr;
+      flattened = yaml["stats"].as<std::vector<size_t>>();
+      if(flattened.size() != yaml["size"].as<size_t>())
+        flattened.clear(); // truncated list
+    } catch(const YAML::Exception& e) {
+      LOG(warn, "[batching] Ignoring unreadable batch statistics in {}: {}", path, e.what());
+      return nullptr;
+    }
+    // number of streams, followed by tuples of stream lengths and batch size
+    if(flattened.size() < 2 || flattened[0] == 0
+       || (flattened.size() - 1) % (flattened[0] + 1) != 0) {
+      LOG(warn, "[batching] Ignoring incomplete batch statistics in {}", path);
+      return nullptr;
+    }
+    return New<BatchStats>(flattened);
+  }
+
   void dump() { // (for debugging)
     for (const auto& entry : map_) {
       for (auto streamLen : entry.first)
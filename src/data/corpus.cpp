@@ -9,71 +9,149 @@
 namespace marian {
 namespace data {
 
+// number of lines each thread encodes per chunk when data-threads > 1
+static const size_t LINES_PER_THREAD = 1000;
+
 Corpus::Corpus(Ptr<Options> options, bool translate /*= false*/)
-    : CorpusBase(options, translate), shuffleInRAM_(options_->get<bool>("shuffle-in-ram")) {}
+    : CorpusBase(options, translate),
+      shuffleInRAM_(options_->get<bool>("shuffle-in-ram")),
+      dataThreads_(options_->get<size_t>("data-threads", 1)) {
+  if(dataThreads_ > 1)
+    threadPool_.reset(new ThreadPool(dataThreads_));
+}
 
 Corpus::Corpus(std::vector<std::string> paths,
                std::vector<Ptr<Vocab>> vocabs,
                Ptr<Options> options)
-    : CorpusBase(paths, vocabs, options), shuffleInRAM_(options_->get<bool>("shuffle-in-ram")) {}
+    : CorpusBase(paths, vocabs, options),
+      shuffleInRAM_(options_->get<bool>("shuffle-in-ram")),
+      dataThreads_(options_->get<size_t>("data-threads", 1)) {
+  if(dataThreads_ > 1)
+    threadPool_.reset(new ThreadPool(dataThreads_));
+}
 
-SentenceTuple Corpus::next() {
-  for (;;) { // (this is a retry loop for skipping invalid sentences)
-    // get index of the current sentence
-    size_t curId = pos_; // note: at end, pos_  == total size
-    // if corpus has been shuffled, ids_ contains sentence indexes
-    if(pos_ < ids_.size())
-      curId = ids_[pos_];
-    pos_++;
-
-    // fill up the sentence tuple with sentences from all input files
-    SentenceTuple tup(curId);
-    size_t eofsHit = 0;
-    size_t numStreams = corpusInRAM_.empty() ? files_.size() : corpusInRAM_.size();
-    for(size_t i = 0; i < numStreams; ++i) {
-      std::string line;
+// reads the lines of the next sentence from all input files, returns false at the end of the corpus
+bool Corpus::readLines(size_t& curId, std::vector<std::string>& lines) {
+  // get index of the current sentence
+  curId = pos_; // note: at end, pos_  == total size
+  // if corpus has been shuffled, ids_ contains sentence indexes
+  if(pos_ < ids_.size())
+    curId = ids_[pos_];
+  pos_++;
 
-      // fetch line, from cached copy in RAM or actual file
-      if (!corpusInRAM_.empty()) {
-        if (curId < corpusInRAM_[i].size())
-          line = corpusInRAM_[i][curId];
-        else {
-          eofsHit++;
-          continue;
-        }
-      }
-      else {
-        bool gotLine = io::getline(*files_[i], line);
-        if(!gotLine) {
-          eofsHit++;
-          continue;
-        }
-      }
+  size_t eofsHit = 0;
+  size_t numStreams = corpusInRAM_.empty() ? files_.size() : corpusInRAM_.size();
+  lines.resize(numStreams);
+  for(size_t i = 0; i < numStreams; ++i) {
+    // fetch line, from cached copy in RAM or actual file
+    if (!corpusInRAM_.empty()) {
+      if (curId < corpusInRAM_[i].size())
+        lines[i] = corpusInRAM_[i][curId];
+      else
+        eofsHit++;
+    }
+    else {
+      bool gotLine = io::getline(*files_[i], lines[i]);
+      if(!gotLine)
+        eofsHit++;
+    }
+  }
 
-      if(i > 0 && i == alignFileIdx_) { // @TODO: alignFileIdx == 0 possible?
-        addAlignmentToSentenceTuple(line, tup);
-      } else if(i > 0 && i == weightFileIdx_) {
-        addWeightsToSentenceTuple(line, tup);
-      } else {
-        addWordsToSentenceTuple(line, i, tup);
-      }
+  if (eofsHit == numStreams)
+    return false;
+  ABORT_IF(eofsHit != 0, "not all input files have the same number of lines");
+  return true;
+}
+
+// fills up the sentence tuple with sentences from all input files
+SentenceTuple Corpus::encodeLines(size_t curId, const std::vector<std::string>& lines) const {
+  SentenceTuple tup(curId);
+  for(size_t i = 0; i < lines.size(); ++i) {
+    if(i > 0 && i == alignFileIdx_) { // @TODO: alignFileIdx == 0 possible?
+      addAlignmentToSentenceTuple(lines[i], tup);
+    } else if(i > 0 && i == weightFileIdx_) {
+      addWeightsToSentenceTuple(lines[i], tup);
+    } else {
+      addWordsToSentenceTuple(lines[i], i, tup);
     }
+  }
+  return tup;
+}
 
-    if (eofsHit == numStreams)
+// checks if all streams are valid, that is, non-empty and no longer than maximum allowed length
+bool Corpus::isValid(const SentenceTuple& tup) const {
+  return std::all_of(tup.begin(), tup.end(), [=](const Words& words) {
+    return words.size() > 0 && words.size() <= maxLength_;
+  });
+}
+
+SentenceTuple Corpus::next() {
+  if(threadPool_)
+    return nextPrefetched();
+
+  std::vector<std::string> lines;
+  for (;;) { // (this is a retry loop for skipping invalid sentences)
+    size_t curId;
+    if(!readLines(curId, lines))
       return SentenceTuple(0);
-    ABORT_IF(eofsHit != 0, "not all input files have the same number of lines");
 
-    // check if all streams are valid, that is, non-empty and no longer than maximum allowed length
-    if(std::all_of(tup.begin(), tup.end(), [=](const Words& words) {
-         return words.size() > 0 && words.size() <= maxLength_;
-       }))
+    SentenceTuple tup = encodeLines(curId, lines);
+    if(isValid(tup))
       return tup;
 
     // otherwise skip this sentence and try the next one
-    // @TODO: tail recursion?
   }
 }
 
+SentenceTuple Corpus::nextPrefetched() {
+  for (;;) {
+    if(prefetchedPos_ == prefetched_.size() && !prefetchChunk())
+      return SentenceTuple(0);
+
+    SentenceTuple& tup = prefetched_[prefetchedPos_++];
+    if(isValid(tup))
+      return std::move(tup);
+  }
+}
+
+// Reads the next chunk of lines sequentially and encodes it on the thread pool. Every
+// thread encodes a contiguous range of the chunk in place, so the order of the resulting
+// sentence tuples is the same as with sequential reading, independent of scheduling.
+bool Corpus::prefetchChunk() {
+  size_t chunkSize = dataThreads_ * LINES_PER_THREAD;
+
+  std::vector<size_t> ids;
+  std::vector<std::vector<std::string>> chunk;
+  ids.reserve(chunkSize);
+  chunk.reserve(chunkSize);
+
+  size_t curId;
+  std::vector<std::string> lines;
+  while(chunk.size() < chunkSize && readLines(curId, lines)) {
+    ids.push_back(curId);
+    chunk.push_back(std::move(lines));
+  }
+
+  prefetched_.assign(chunk.size(), SentenceTuple(0));
+  prefetchedPos_ = 0;
+  if(chunk.empty())
+    return false;
+
+  size_t linesPerTask = (chunk.size() + dataThreads_ - 1) / dataThreads_;
+  std::vector<std::future<void>> tasks;
+  for(size_t begin = 0; begin < chunk.size(); begin += linesPerTask) {
+    size_t end = std::min(begin + linesPerTask, chunk.size());
+    tasks.emplace_back(threadPool_->enqueue([&, begin, end]() {
+      for(size_t k = begin; k < end; ++k)
+        prefetched_[k] = encodeLines(ids[k], chunk[k]);
+    }));
+  }
+  for(auto& task : tasks)
+    task.get();
+
+  return true;
+}
+
 // reset and initialize shuffled reading
 // Call either reset() or shuffle().
 // @TODO: merge with reset() below to clarify mutual exclusiveness with reset()
@@ -88,6 +166,8 @@ void Corpus::reset() {
   files_.clear();
   corpusInRAM_.clear();
   ids_.clear();
+  prefetched_.clear();
+  prefetchedPos_ = 0;
   pos_ = 0;
   for(auto& path : paths_) {
     if(path == "stdin")
@@ -102,6 +182,12 @@ void Corpus::restore(Ptr<TrainingState> ts) {
 }
 
 void Corpus::shuffleData(const std::vector<std::string>& paths) {
+  size_t maxBytes = options_->get<size_t>("shuffle-memory", 0) * 1024 * 1024;
+  if(maxBytes > 0 && !shuffleInRAM_) {
+    shuffleDataExternal(paths, maxBytes);
+    return;
+  }
+
   LOG(info, "[data] Shuffling files");
 
   size_t numStreams = paths.size();
@@ -166,6 +252,152 @@ void Corpus::shuffleData(const std::vector<std::string>& paths) {
     }
     LOG(info, "[data] Done shuffling {} sentences to temp files", numSentences);
   }
+  prefetched_.clear();
+  prefetchedPos_ = 0;
+  pos_ = 0;
+}
+
+// Shuffles the corpus in bounded memory. The first pass reads chunks of at most maxBytes of
+// text, shuffles each of them in RAM and writes it as a run of compressed temporary files.
+// The second pass merges the runs, drawing the next sentence from a run with probability
+// proportional to the number of sentences left in it, which makes the merged run a uniformly
+// random permutation of the sentences in the merged runs. Large corpora are merged in several
+// passes to bound the number of open files. Sentence ids are the positions in the
+// shuffled corpus, as keeping the original ids would take memory linear in the corpus size.
+void Corpus::shuffleDataExternal(const std::vector<std::string>& paths, size_t maxBytes) {
+  LOG(info, "[data] Shuffling files out-of-core using at most {} MB of RAM", maxBytes / (1024 * 1024));
+
+  size_t numStreams = paths.size();
+
+  files_.resize(numStreams);
+  for(size_t i = 0; i < numStreams; ++i) {
+    files_[i].reset(new io::InputFileStream(paths[i]));
+    files_[i]->setbufsize(10000000); // huge read-ahead buffer to avoid network round-trips
+  }
+
+  std::vector<std::vector<UPtr<io::TemporaryFile>>> runs; // [run][stream]
+  std::vector<size_t> runSizes;                            // [run] number of sentences
+
+  std::vector<std::vector<std::string>> chunk(numStreams); // [stream][id]
+  size_t chunkBytes = 0;
+  std::vector<size_t> chunkIds;
+
+  auto writeRun = [&]() {
+    size_t numSentences = chunk[0].size();
+    chunkIds.resize(numSentences);
+    std::iota(chunkIds.begin(), chunkIds.end(), 0);
+    std::shuffle(chunkIds.begin(), chunkIds.end(), eng_);
+
+    runs.emplace_back();
+    for(size_t i = 0; i < numStreams; ++i) {
+      runs.back().emplace_back(new io::TemporaryFile(options_->get<std::string>("tempdir")));
+      io::OutputFileStream out(*runs.back().back(), /*gzipped=*/true);
+      for(auto id : chunkIds)
+        out << chunk[i][id] << "\n";
+      chunk[i].clear();
+    }
+    runSizes.push_back(numSentences);
+    chunkBytes = 0;
+  };
+
+  // pass 1: shuffled runs
+  std::string lineBuf;
+  for (;;) {
+    size_t eofsHit = 0;
+    for(size_t i = 0; i < numStreams; ++i) {
+      bool gotLine = io::getline(*files_[i], lineBuf);
+      if (gotLine) {
+        chunkBytes += lineBuf.size() + sizeof(std::string);
+        chunk[i].push_back(lineBuf);
+      }
+      else
+        eofsHit++;
+    }
+    if (eofsHit == numStreams)
+      break;
+    ABORT_IF(eofsHit != 0, "Not all input files have the same number of lines");
+
+    if(chunkBytes >= maxBytes)
+      writeRun();
+  }
+  if(!chunk[0].empty())
+    writeRun();
+  files_.clear();
+  chunk.clear();
+
+  size_t numSentences = std::accumulate(runSizes.begin(), runSizes.end(), (size_t)0);
+  LOG(info, "[data] Done writing {} sentences in {} shuffled runs", numSentences, runs.size());
+
+  // pass 2: random interleaving of the runs. Every open compressed stream holds about 2 MB of
+  // buffers and a file descriptor, so at most maxFanIn runs are merged at once, which may need
+  // several passes. A merged run is again a uniformly random permutation of its sentences.
+  const size_t streamBytes = 2 * (1 << 20);
+  size_t streamsFit = maxBytes / (numStreams * streamBytes); // runs plus the merged output
+  size_t maxFanIn = std::min((size_t)64, std::max((size_t)2, streamsFit > 1 ? streamsFit - 1 : 0));
+
+  // merges runs [begin, end) into a new run
+  auto mergeRuns = [&](size_t begin, size_t end) {
+    std::vector<std::vector<UPtr<io::InputFileStream>>> runFiles; // [run][stream]
+    std::vector<size_t> left(runSizes.begin() + begin, runSizes.begin() + end);
+    for(size_t r = begin; r < end; ++r) {
+      runFiles.emplace_back();
+      for(size_t i = 0; i < numStreams; ++i)
+        runFiles.back().emplace_back(new io::InputFileStream(*runs[r][i], /*gzipped=*/true));
+    }
+
+    std::vector<UPtr<io::TemporaryFile>> merged(numStreams);
+    std::vector<UPtr<io::OutputFileStream>> outs(numStreams);
+    for(size_t i = 0; i < numStreams; ++i) {
+      merged[i].reset(new io::TemporaryFile(options_->get<std::string>("tempdir")));
+      outs[i].reset(new io::OutputFileStream(*merged[i], /*gzipped=*/true));
+    }
+
+    size_t total = std::accumulate(left.begin(), left.end(), (size_t)0);
+    for(size_t remaining = total; remaining > 0; --remaining) {
+      size_t pick = std::uniform_int_distribution<size_t>(0, remaining - 1)(eng_);
+      size_t r = 0;
+      while(pick >= left[r]) {
+        pick -= left[r];
+        ++r;
+      }
+      left[r]--;
+
+      for(size_t i = 0; i < numStreams; ++i) {
+        io::getline(*runFiles[r][i], lineBuf);
+        *outs[i] << lineBuf << "\n";
+      }
+    }
+    return merged;
+  };
+
+  while(runs.size() > maxFanIn) {
+    std::vector<std::vector<UPtr<io::TemporaryFile>>> mergedRuns;
+    std::vector<size_t> mergedSizes;
+    for(size_t begin = 0; begin < runs.size(); begin += maxFanIn) {
+      size_t end = std::min(begin + maxFanIn, runs.size());
+      mergedRuns.push_back(end - begin == 1 ? std::move(runs[begin]) : mergeRuns(begin, end));
+      mergedSizes.push_back(
+          std::accumulate(runSizes.begin() + begin, runSizes.begin() + end, (size_t)0));
+    }
+    runs.swap(mergedRuns);
+    runSizes.swap(mergedSizes);
+    LOG(info, "[data] Merged shuffled runs into {} runs", runs.size());
+  }
+
+  tempFiles_ = mergeRuns(0, runs.size());
+  runs.clear();
+
+  ids_.clear();
+
+  // replace files_[] by the tempfiles we just created
+  files_.resize(numStreams);
+  for(size_t i = 0; i < numStreams; ++i) {
+    files_[i].reset(new io::InputFileStream(*tempFiles_[i], /*gzipped=*/true));
+  }
+  LOG(info, "[data] Done shuffling {} sentences to compressed temp files", numSentences);
+
+  prefetched_.clear();
+  prefetchedPos_ = 0;
   pos_ = 0;
 }
 }  // namespace data
@@ -12,6 +12,7 @@
 #include "data/corpus_base.h"
 #include "data/dataset.h"
 #include "data/vocab.h"
+#include "3rd_party/threadpool.h"
 
 namespace marian {
 namespace data {
@@ -25,7 +26,21 @@ private:
   bool shuffleInRAM_{false};
   std::vector<std::vector<std::string>> corpusInRAM_; // // [stream][id] full copy of all data files
 
+  // for data-threads > 1: lines are read sequentially in chunks and encoded in parallel
+  size_t dataThreads_{1};
+  UPtr<ThreadPool> threadPool_;
+  std::vector<SentenceTuple> prefetched_; // encoded chunk, in corpus order
+  size_t prefetchedPos_{0};
+
   void shuffleData(const std::vector<std::string>& paths);
+  void shuffleDataExternal(const std::vector<std::string>& paths, size_t maxBytes);
+
+  bool readLines(size_t& curId, std::vector<std::string>& lines);
+  SentenceTuple encodeLines(size_t curId, const std::vector<std::string>& lines) const;
+  bool isValid(const SentenceTuple& tup) const;
+
+  bool prefetchChunk();
+  SentenceTuple nextPrefetched();
 
 public:
   // @TODO: check if translate can be replaced by an option in options
@@ -195,7 +195,10 @@ void CorpusBase::addWordsToSentenceTuple(const std::string& line,
   // on the vocabulary type, this can be non-trivial, e.g. when SentencePiece
   // is used.
   Words words = vocabs_[i]->encode(line, /*addEOS =*/ true, inference_);
+  addWordsToSentenceTuple(std::move(words), tup);
+}
 
+void CorpusBase::addWordsToSentenceTuple(Words words, SentenceTuple& tup) const {
   if(words.empty())
     words.push_back(0);
 
@@ -207,16 +210,20 @@ void CorpusBase::addWordsToSentenceTuple(const std::string& line,
   if(rightLeft_)
     std::reverse(words.begin(), words.end() - 1);
 
-  tup.push_back(words);
+  tup.push_back(std::move(words));
 }
 
 void CorpusBase::addAlignmentToSentenceTuple(const std::string& line,
                                              SentenceTuple& tup) const {
+  addAlignmentToSentenceTuple(WordAlignment(line), tup);
+}
+
+void CorpusBase::addAlignmentToSentenceTuple(const WordAlignment& align,
+                                             SentenceTuple& tup) const {
   ABORT_IF(rightLeft_,
            "Guided alignment and right-left model cannot be used "
            "together at the moment");
 
-  auto align = WordAlignment(line);
   tup.setAlignment(align);
 }
 
@@ -230,12 +237,19 @@ void CorpusBase::addWeightsToSentenceTuple(const std::string& line, SentenceTupl
         break;
       weights.emplace_back(std::stof(e));
     }
+    addWeightsToSentenceTuple(std::move(weights), tup);
+  }
+}
 
-    if(rightLeft_)
-      std::reverse(weights.begin(), weights.end());
+void CorpusBase::addWeightsToSentenceTuple(std::vector<float> weights,
+                                           SentenceTuple& tup) const {
+  if(maxLengthCrop_ && weights.size() > maxLength_ + 1)
+    weights.resize(maxLength_ + 1);
 
-    tup.setWeights(weights);
-  }
+  if(rightLeft_)
+    std::reverse(weights.begin(), weights.end());
+
+  tup.setWeights(std::move(weights));
 }
 
 void CorpusBase::addAlignmentsToBatch(Ptr<CorpusBatch> batch,
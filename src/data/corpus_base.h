@@ -37,8 +37,6 @@ public:
    */
   SentenceTuple(size_t id) : id_(id) {}
 
-  ~SentenceTuple() { tuple_.clear(); }
-
   /**
    * @brief Returns the sentence's ID.
    */
@@ -50,6 +48,7 @@ public:
    * @param words A vector of word indexes.
    */
   void push_back(const Words& words) { tuple_.push_back(words); }
+  void push_back(Words&& words) { tuple_.push_back(std::move(words)); }
 
   /**
    * @brief The size of the tuple, e.g. two for parallel data with a source and
@@ -88,7 +87,7 @@ public:
    * For sentence-level weights the vector contains only one element.
    */
   const std::vector<float>& getWeights() const { return weights_; }
-  void setWeights(const std::vector<float>& weights) {
+  void setWeights(std::vector<float> weights) {
     auto numTrgWords = back().size();
     auto numWeights = weights.size();
     if(numWeights != 1 && numWeights != numTrgWords && numWeights != numTrgWords - 1)
@@ -98,11 +97,11 @@ public:
           numWeights,
           numTrgWords,
           id_);
-    weights_ = weights;
+    weights_ = std::move(weights);
   }
 
   const WordAlignment& getAlignment() const { return alignment_; }
-  void setAlignment(const WordAlignment& alignment) { alignment_ = alignment; }
+  void setAlignment(WordAlignment alignment) { alignment_ = std::move(alignment); }
 };
 
 /**
@@ -225,7 +224,7 @@ public:
  * @brief Batch of source and target sentences with additional information,
  * such as guided alignments and sentence or word-leve weighting.
  */
-class CorpusBatch : public Batch {
+class CorpusBatch : public Batch, public std::enable_shared_from_this<CorpusBatch> {
 private:
   std::vector<Ptr<SubBatch>> subBatches_;
   std::vector<float> guidedAlignment_;
@@ -360,6 +359,10 @@ public:
   std::vector<Ptr<Batch>> split(size_t n) override {
     ABORT_IF(size() == 0, "Encoutered batch size of 0");
 
+    // a single split is the batch itself, batches are not modified after creation
+    if(n == 1)
+      return {shared_from_this()};
+
     std::vector<std::vector<Ptr<SubBatch>>> subs;
     // split each subbatch separately
     for(auto subBatch : subBatches_) {
@@ -538,18 +541,27 @@ protected:
   void addWordsToSentenceTuple(const std::string& line,
                                size_t i,
                                SentenceTuple& tup) const;
+  /**
+   * @brief Helper function adding already encoded words to the sentence tuple,
+   * applying length cropping and right-left reversal.
+   */
+  void addWordsToSentenceTuple(Words words, SentenceTuple& tup) const;
   /**
    * @brief Helper function parsing a line with word alignments and adding them
    * to the sentence tuple.
    */
   void addAlignmentToSentenceTuple(const std::string& line,
                                    SentenceTuple& tup) const;
+  void addAlignmentToSentenceTuple(const WordAlignment& align,
+                                   SentenceTuple& tup) const;
   /**
    * @brief Helper function parsing a line of weights and adding them to the
    * sentence tuple.
    */
   void addWeightsToSentenceTuple(const std::string& line,
                                  SentenceTuple& tup) const;
+  void addWeightsToSentenceTuple(std::vector<float> weights,
+                                 SentenceTuple& tup) const;
 
   void addAlignmentsToBatch(Ptr<CorpusBatch> batch,
                             const std::vector<Sample>& batchVector);
@@ -0,0 +1,298 @@
+#include "data/corpus_binary.h"
+
+#include <cstring>
+#include <numeric>
+#include <random>
+
+#include "common/utils.h"
+
+namespace marian {
+namespace data {
+
+// Layout of a binary corpus file, all numbers in native byte order:
+//
+//   char[8]   magic "MARIANBC"
+//   uint64_t  version
+//   for each stream: items (Word, AlignmentPoint or float), padded to 8 bytes,
+//                    followed by uint64_t offsets[numSentences + 1]
+//   uint64_t  numSentences
+//   uint64_t  numStreams
+//   StreamHeader[numStreams]
+//   uint64_t  position of numSentences above
+namespace binary {
+
+static const char MAGIC[8] = {'M', 'A', 'R', 'I', 'A', 'N', 'B', 'C'};
+static const uint64_t VERSION = 1;
+
+struct StreamHeader {
+  uint64_t type;
+  uint64_t vocabSize;    // 0 for alignments and weights
+  uint64_t itemsPos;     // byte position of the first item
+  uint64_t offsetsPos;   // byte position of the offsets index
+};
+
+struct AlignmentPoint {
+  uint32_t srcPos;
+  uint32_t tgtPos;
+  float prob;
+};
+
+class Writer {
+private:
+  io::OutputFileStream out_;
+  size_t pos_{0};
+
+public:
+  Writer(const std::string& path) : out_(path) {}
+
+  template <typename T>
+  void write(const T* ptr, size_t num = 1) {
+    pos_ += out_.write(ptr, num);
+  }
+
+  void pad() {
+    static const char zeros[8] = {0};
+    if(pos_ % 8 != 0)
+      write(zeros, 8 - pos_ % 8);
+  }
+
+  size_t pos() const { return pos_; }
+};
+}  // namespace binary
+
+CorpusBinary::CorpusBinary(Ptr<Options> options, bool translate /*= false*/)
+    : CorpusBase(options, translate) {
+  // text files are only needed for creating or checking vocabularies
+  files_.clear();
+  map(options_->get<std::string>("binary-corpus"));
+}
+
+void CorpusBinary::map(const std::string& path) {
+  ABORT_IF(!filesystem::exists(path), "Binary corpus '{}' does not exist", path);
+  file_.open(path);
+  ABORT_IF(!file_.is_open(), "Binary corpus '{}' could not be mapped", path);
+
+  const char* data = file_.data();
+  size_t size = file_.size();
+
+  ABORT_IF(size < sizeof(binary::MAGIC) + 3 * sizeof(uint64_t)
+               || std::memcmp(data, binary::MAGIC, sizeof(binary::MAGIC)) != 0,
+           "File '{}' is not a binary corpus",
+           path);
+  uint64_t version = *(const uint64_t*)(data + sizeof(binary::MAGIC));
+  ABORT_IF(version != binary::VERSION,
+           "Binary corpus versions do not match: {} (file) != {} (expected)",
+           version,
+           binary::VERSION);
+
+  // all positions come from the file, check them before following them, e.g. for files that were
+  // not written completely
+  size_t tocEnd = size - sizeof(uint64_t);
+  uint64_t tocPos = *(const uint64_t*)(data + tocEnd);
+  ABORT_IF(tocPos < sizeof(binary::MAGIC) + sizeof(uint64_t) || tocPos > tocEnd
+               || tocEnd - tocPos < 2 * sizeof(uint64_t),
+           "Binary corpus '{}' is truncated or corrupted (invalid table of contents)",
+           path);
+  const uint64_t* toc = (const uint64_t*)(data + tocPos);
+  numSentences_ = toc[0];
+  size_t numStreams = toc[1];
+  ABORT_IF(numStreams > (tocEnd - tocPos - 2 * sizeof(uint64_t)) / sizeof(binary::StreamHeader)
+               || tocPos + 2 * sizeof(uint64_t) + numStreams * sizeof(binary::StreamHeader) != tocEnd,
+           "Binary corpus '{}' is truncated or corrupted (invalid stream headers)",
+           path);
+  const binary::StreamHeader* headers = (const binary::StreamHeader*)(toc + 2);
+
+  ABORT_IF(numStreams != paths_.size(),
+           "Binary corpus '{}' contains {} streams, but {} are expected from the training options",
+           path,
+           numStreams,
+           paths_.size());
+
+  streams_.clear();
+  for(size_t i = 0; i < numStreams; ++i) {
+    StreamType expected = StreamType::Words;
+    if(i > 0 && i == alignFileIdx_)
+      expected = StreamType::Alignment;
+    else if(i > 0 && i == weightFileIdx_)
+      expected = StreamType::Weights;
+
+    ABORT_IF((StreamType)headers[i].type != expected,
+             "Stream {} of binary corpus '{}' does not match the training options "
+             "(mismatch of alignments or weights?)",
+             i,
+             path);
+    ABORT_IF(expected == StreamType::Words && headers[i].vocabSize != vocabs_[i]->size(),
+             "Stream {} of binary corpus '{}' has been encoded with a vocabulary of size {}, "
+             "but the given vocabulary has size {}",
+             i,
+             path,
+             headers[i].vocabSize,
+             vocabs_[i]->size());
+
+    // items lie before the offsets, and the offsets before the table of contents
+    size_t itemSize = expected == StreamType::Alignment ? sizeof(binary::AlignmentPoint)
+                      : expected == StreamType::Weights ? sizeof(float)
+                                                        : sizeof(Word);
+    const auto& header = headers[i];
+    bool valid = header.itemsPos <= header.offsetsPos && header.offsetsPos <= tocPos
+                 && header.offsetsPos % sizeof(uint64_t) == 0
+                 && numSentences_ < (tocPos - header.offsetsPos) / sizeof(uint64_t);
+    if(valid) {
+      const uint64_t* offsets = (const uint64_t*)(data + header.offsetsPos);
+      uint64_t numItems = offsets[numSentences_];
+      valid = numItems <= (header.offsetsPos - header.itemsPos) / itemSize;
+      for(size_t s = 0; valid && s < numSentences_; ++s)
+        valid = offsets[s] <= offsets[s + 1];
+    }
+    ABORT_IF(!valid,
+             "Binary corpus '{}' is truncated or corrupted (invalid stream {})",
+             path,
+             i);
+
+    streams_.push_back({expected,
+                        (const uint64_t*)(data + headers[i].offsetsPos),
+                        data + headers[i].itemsPos});
+  }
+
+  LOG(info, "[data] Mapped binary corpus {} with {} sentences", path, numSentences_);
+}
+
+SentenceTuple CorpusBinary::next() {
+  while(pos_ < numSentences_) {
+    // if corpus has been shuffled, ids_ contains sentence indexes
+    size_t curId = pos_ < ids_.size() ? ids_[pos_] : pos_;
+    pos_++;
+
+    SentenceTuple tup(curId);
+    for(size_t i = 0; i < streams_.size(); ++i) {
+      const auto& stream = streams_[i];
+      size_t begin = stream.offsets[curId];
+      size_t end = stream.offsets[curId + 1];
+
+      if(stream.type == StreamType::Alignment) {
+        auto points = (const binary::AlignmentPoint*)stream.items;
+        WordAlignment align;
+        for(size_t k = begin; k < end; ++k)
+          align.push_back(points[k].srcPos, points[k].tgtPos, points[k].prob);
+        addAlignmentToSentenceTuple(align, tup);
+      } else if(stream.type == StreamType::Weights) {
+        auto weights = (const float*)stream.items;
+        if(begin != end)
+          addWeightsToSentenceTuple(std::vector<float>(weights + begin, weights + end), tup);
+      } else {
+        auto words = (const Word*)stream.items;
+        addWordsToSentenceTuple(Words(words + begin, words + end), tup);
+      }
+    }
+
+    // check if all streams are valid, that is, non-empty and no longer than maximum allowed length
+    if(std::all_of(tup.begin(), tup.end(), [=](const Words& words) {
+         return words.size() > 0 && words.size() <= maxLength_;
+       }))
+      return tup;
+  }
+  return SentenceTuple(0);
+}
+
+void CorpusBinary::shuffle() {
+  LOG(info, "[data] Shuffling {} sentences of binary corpus", numSentences_);
+  ids_.resize(numSentences_);
+  std::iota(ids_.begin(), ids_.end(), 0);
+  std::shuffle(ids_.begin(), ids_.end(), eng_);
+  pos_ = 0;
+}
+
+void CorpusBinary::reset() {
+  ids_.clear();
+  pos_ = 0;
+}
+
+void CorpusBinary::restore(Ptr<TrainingState> ts) {
+  setRNGState(ts->seedCorpus);
+}
+
+void CorpusBinary::binarize(const std::vector<std::string>& paths,
+                            const std::vector<Ptr<Vocab>>& vocabs,
+                            const std::string& alignPath,
+                            const std::string& weightsPath,
+                            const std::string& outputPath) {
+  ABORT_IF(paths.size() != vocabs.size(),
+           "Number of corpus files and vocab files does not agree");
+  ABORT_IF(filesystem::Path(outputPath).extension() == filesystem::Path(".gz"),
+           "Binary corpus cannot be compressed as it is memory-mapped");
+
+  std::vector<std::pair<std::string, StreamType>> streams;
+  for(auto& path : paths)
+    streams.emplace_back(path, StreamType::Words);
+  if(!alignPath.empty())
+    streams.emplace_back(alignPath, StreamType::Alignment);
+  if(!weightsPath.empty())
+    streams.emplace_back(weightsPath, StreamType::Weights);
+
+  binary::Writer out(outputPath);
+  out.write(binary::MAGIC, sizeof(binary::MAGIC));
+  out.write(&binary::VERSION);
+
+  size_t numSentences = 0;
+  std::vector<binary::StreamHeader> headers;
+  for(size_t i = 0; i < streams.size(); ++i) {
+    const auto& path = streams[i].first;
+    StreamType type = streams[i].second;
+    LOG(info, "[data] Encoding {}", path);
+
+    binary::StreamHeader header;
+    header.type = (uint64_t)type;
+    header.vocabSize = type == StreamType::Words ? vocabs[i]->size() : 0;
+    header.itemsPos = out.pos();
+
+    std::vector<uint64_t> offsets(1, 0);
+    io::InputFileStream in(path);
+    std::string line;
+    while(io::getline(in, line)) {
+      size_t numItems = 0;
+      if(type == StreamType::Alignment) {
+        for(auto p : WordAlignment(line)) {
+          binary::AlignmentPoint point{(uint32_t)p.srcPos, (uint32_t)p.tgtPos, p.prob};
+          out.write(&point);
+          numItems++;
+        }
+      } else if(type == StreamType::Weights) {
+        for(auto& e : utils::split(line, " ")) {
+          float weight = std::stof(e);
+          out.write(&weight);
+          numItems++;
+        }
+      } else {
+        Words words = vocabs[i]->encode(line, /*addEOS =*/ true, /*inference =*/ false);
+        out.write(words.data(), words.size());
+        numItems = words.size();
+      }
+      offsets.push_back(offsets.back() + numItems);
+    }
+
+    if(i == 0)
+      numSentences = offsets.size() - 1;
+    ABORT_IF(offsets.size() - 1 != numSentences,
+             "File '{}' has {} lines, but {} were expected",
+             path,
+             offsets.size() - 1,
+             numSentences);
+
+    out.pad();
+    header.offsetsPos = out.pos();
+    out.write(offsets.data(), offsets.size());
+    headers.push_back(header);
+  }
+
+  uint64_t tocPos = out.pos();
+  uint64_t numStreams = headers.size();
+  uint64_t numSentencesOut = numSentences;
+  out.write(&numSentencesOut);
+  out.write(&numStreams);
+  out.write(headers.data(), headers.size());
+  out.write(&tocPos);
+
+  LOG(info, "[data] Wrote binary corpus {} with {} sentences", outputPath, numSentences);
+}
+}  // namespace data
+}  // namespace marian
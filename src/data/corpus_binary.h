@@ -0,0 +1,129 @@
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "common/definitions.h"
+#include "common/file_stream.h"
+#include "common/options.h"
+#include "data/alignment.h"
+#include "data/batch.h"
+#include "data/corpus_base.h"
+#include "data/dataset.h"
+#include "data/vocab.h"
+
+namespace marian {
+namespace data {
+
+/**
+ * @brief Training corpus read from a memory-mapped binary file with already
+ * encoded sentences.
+ *
+ * The file is created with marian-binarize from the training files and
+ * vocabularies. Every stream (source, target, alignments and weights) is stored
+ * as a flat array of items and an index of per-sentence offsets into that
+ * array, so reading a sentence tuple requires neither text parsing nor
+ * vocabulary lookups. Shuffling permutes sentence ids only, the data is never
+ * copied into RAM or temporary files.
+ */
+class CorpusBinary : public CorpusBase {
+private:
+  enum class StreamType : uint64_t { Words = 0, Alignment = 1, Weights = 2 };
+
+  struct Stream {
+    StreamType type;
+    const uint64_t* offsets; // [numSentences + 1] item offsets
+    const char* items;
+  };
+
+  boost::iostreams::mapped_file_source file_;
+  std::vector<Stream> streams_; // same order as paths_
+  size_t numSentences_{0};
+
+  std::vector<size_t> ids_;
+
+  void map(const std::string& path);
+
+public:
+  CorpusBinary(Ptr<Options> options, bool translate = false);
+
+  /**
+   * @brief Iterates sentence tuples in the corpus.
+   *
+   * Applies the same length filtering, cropping and right-left reversal as
+   * marian::data::Corpus.
+   */
+  Sample next() override;
+
+  void shuffle() override;
+
+  void reset() override;
+
+  void restore(Ptr<TrainingState>) override;
+
+  iterator begin() override { return iterator(this); }
+
+  iterator end() override { return iterator(); }
+
+  std::vector<Ptr<Vocab>>& getVocabs() override { return vocabs_; }
+
+  batch_ptr toBatch(const std::vector<Sample>& batchVector) override {
+    size_t batchSize = batchVector.size();
+
+    std::vector<size_t> sentenceIds;
+
+    std::vector<int> maxDims;
+    for(auto& ex : batchVector) {
+      if(maxDims.size() < ex.size())
+        maxDims.resize(ex.size(), 0);
+      for(size_t i = 0; i < ex.size(); ++i) {
+        if(ex[i].size() > (size_t)maxDims[i])
+          maxDims[i] = (int)ex[i].size();
+      }
+      sentenceIds.push_back(ex.getId());
+    }
+
+    std::vector<Ptr<SubBatch>> subBatches;
+    for(size_t j = 0; j < maxDims.size(); ++j) {
+      subBatches.emplace_back(New<SubBatch>(batchSize, maxDims[j], vocabs_[j]));
+    }
+
+    std::vector<size_t> words(maxDims.size(), 0);
+    for(size_t i = 0; i < batchSize; ++i) {
+      for(size_t j = 0; j < maxDims.size(); ++j) {
+        for(size_t k = 0; k < batchVector[i][j].size(); ++k) {
+          subBatches[j]->data()[k * batchSize + i] = batchVector[i][j][k];
+          subBatches[j]->mask()[k * batchSize + i] = 1.f;
+          words[j]++;
+        }
+      }
+    }
+
+    for(size_t j = 0; j < maxDims.size(); ++j)
+      subBatches[j]->setWords(words[j]);
+
+    auto batch = batch_ptr(new batch_type(subBatches));
+    batch->setSentenceIds(sentenceIds);
+
+    if(options_->get("guided-alignment", std::string("none")) != "none" && alignFileIdx_)
+      addAlignmentsToBatch(batch, batchVector);
+    if(options_->has("data-weighting") && weightFileIdx_)
+      addWeightsToBatch(batch, batchVector);
+
+    return batch;
+  }
+
+  /**
+   * @brief Encodes parallel text files with the given vocabularies and writes
+   * them into a binary corpus file readable by this class.
+   *
+   * Alignments and weights are added as additional streams if the respective
+   * paths are not empty, in the same order as in marian::data::CorpusBase.
+   */
+  static void binarize(const std::vector<std::string>& paths,
+                       const std::vector<Ptr<Vocab>>& vocabs,
+                       const std::string& alignPath,
+                       const std::string& weightsPath,
+                       const std::string& outputPath);
+};
+}  // namespace data
+}  // namespace marian
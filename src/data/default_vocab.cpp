@@ -17,12 +17,20 @@ namespace marian {
 
 class DefaultVocab : public VocabBase {
 private:
-  typedef std::map<std::string, Word> Str2Id;
+  // Open-addressing hash table from words to ids with linear probing. Slots only hold ids,
+  // the keys are the strings in id2str_, so a lookup of a (pointer, length) token of a line
+  // needs no string allocation. The size is a power of two and kept at most half full.
+  typedef std::vector<Word> Str2Id;
   Str2Id str2id_;
+  size_t str2idEntries_{0};
 
   typedef std::vector<std::string> Id2Str;
   Id2Str id2str_;
 
+  // Words that share their id with the word in id2str_ (possible in JSON/Yaml vocabs). Their
+  // slots hold ALIAS | index into aliases_, so they keep their own key.
+  std::vector<std::pair<std::string, Word>> aliases_;
+
   Word eosId_ = (Word)-1;
   Word unkId_ = (Word)-1;
 
@@ -48,17 +56,27 @@ public:
   virtual const std::vector<std::string>& suffixes() const override { return suffixes_; }
 
   virtual Word operator[](const std::string& word) const override {
-    auto it = str2id_.find(word);
-    if(it != str2id_.end())
-      return it->second;
-    else
-      return unkId_;
+    Word id = lookup(word.data(), word.size());
+    return id == NO_ID ? unkId_ : id;
   }
 
   Words encode(const std::string& line, bool addEOS, bool /*inference*/) const override {
-    std::vector<std::string> lineTokens;
-    utils::split(line, lineTokens, " ");
-    return (*this)(lineTokens, addEOS);
+    // split on single spaces like utils::split(), but look up tokens in place
+    Words words;
+    size_t begin = 0;
+    while(begin < line.size()) {
+      size_t end = line.find(' ', begin);
+      if(end == std::string::npos)
+        end = line.size();
+      if(end > begin) {
+        Word id = lookup(line.data() + begin, end - begin);
+        words.push_back(id == NO_ID ? unkId_ : id);
+      }
+      begin = end + 1;
+    }
+    if(addEOS)
+      words.push_back(eosId_);
+    return words;
   }
 
   std::string decode(const Words& sentence, bool ignoreEOS) const override {
@@ -115,6 +133,7 @@ public:
     std::unordered_set<Word> seenSpecial;
 
     id2str_.reserve(vocab.size());
+    resizeStr2Id(vocab.size());
     for(auto&& pair : vocab) {
       auto str = pair.first;
       auto id = pair.second;
@@ -147,12 +166,12 @@ public:
           return backCompatId;
         }
       }
-      auto iter = str2id_.find(str);
-      ABORT_IF(iter == str2id_.end(),
+      Word id = lookup(str.data(), str.size());
+      ABORT_IF(id == NO_ID,
               "DefaultVocabulary file {} is expected to contain an entry for {}",
               vocabPath,
               str);
-      return iter->second;
+      return id;
     };
     eosId_ = getRequiredWordId(DEFAULT_EOS_STR, NEMATUS_EOS_STR, DEFAULT_EOS_ID);
     unkId_ = getRequiredWordId(DEFAULT_UNK_STR, NEMATUS_UNK_STR, DEFAULT_UNK_ID);
@@ -160,10 +179,10 @@ public:
     // some special symbols for hard attention
     if(!seenSpecial.empty()) {
       auto requireWord = [&](Word id, const std::string& str) {
-        auto iter = str2id_.find(str);
+        Word found = lookup(str.data(), str.size());
         // word already in vocab: must be at right index, else fail
-        if(iter != str2id_.end())
-          ABORT_IF(iter->second != id,
+        if(found != NO_ID)
+          ABORT_IF(found != id,
                   "special vocabulary entry '{}' is expected to have id {}",
                   str,
                   id);
@@ -265,18 +284,6 @@ private:
     *vocabStrm << vocabYaml;
   }
 
-  Words operator()(const std::vector<std::string>& lineTokens,
-                   bool addEOS) const {
-    Words words(lineTokens.size());
-    std::transform(lineTokens.begin(),
-                  lineTokens.end(),
-                  words.begin(),
-                  [&](const std::string& w) { return (*this)[w]; });
-    if(addEOS)
-      words.push_back(eosId_);
-    return words;
-  }
-
   std::vector<std::string> operator()(const Words& sentence,
                                       bool ignoreEOS) const {
     std::vector<std::string> decoded;
@@ -288,16 +295,99 @@ private:
     return decoded;
   }
 
+  // marks empty slots in str2id_[]
+  static const Word NO_ID = (Word)-1;
+  // marks slots of aliases_
+  static const Word ALIAS = (Word)1 << (8 * sizeof(Word) - 1);
+
+  const std::string& slotKey(Word entry) const {
+    return entry & ALIAS ? aliases_[entry & ~ALIAS].first : id2str_[entry];
+  }
+
+  Word slotId(Word entry) const { return entry & ALIAS ? aliases_[entry & ~ALIAS].second : entry; }
+
+  // FNV-1a
+  static size_t hashWord(const char* str, size_t size) {
+    uint64_t h = 14695981039346656037ull;
+    for(size_t i = 0; i < size; ++i) {
+      h ^= (unsigned char)str[i];
+      h *= 1099511628211ull;
+    }
+    return (size_t)h;
+  }
+
+  // returns the slot holding the id of the given word, or the empty slot where it belongs.
+  // The table must not be empty.
+  size_t findSlot(const char* str, size_t size) const {
+    size_t mask = str2id_.size() - 1;
+    size_t slot = hashWord(str, size) & mask;
+    for(;;) {
+      Word entry = str2id_[slot];
+      if(entry == NO_ID)
+        return slot;
+      const std::string& key = slotKey(entry);
+      if(key.size() == size && std::equal(str, str + size, key.data()))
+        return slot;
+      slot = (slot + 1) & mask;
+    }
+  }
+
+  // returns the id of the given word, or NO_ID
+  Word lookup(const char* str, size_t size) const {
+    if(str2id_.empty())
+      return NO_ID;
+    Word entry = str2id_[findSlot(str, size)];
+    return entry == NO_ID ? NO_ID : slotId(entry);
+  }
+
+  // rehashes str2id_[] to a size that keeps the table at most half full for numWords entries
+  void resizeStr2Id(size_t numWords) {
+    size_t size = 16;
+    while(size < 2 * numWords)
+      size *= 2;
+    if(size <= str2id_.size())
+      return;
+
+    Str2Id old(size, NO_ID);
+    std::swap(old, str2id_);
+    for(Word entry : old) {
+      if(entry != NO_ID) {
+        const std::string& key = slotKey(entry);
+        str2id_[findSlot(key.data(), key.size())] = entry;
+      }
+    }
+  }
+
   // helper to insert a word into str2id_[] and id2str_[]
   Word insertWord(Word id, const std::string& str) {
-    str2id_[str] = id;
+    ABORT_IF(id & ALIAS, "Word id {} is too large", id);
     if(id >= id2str_.size())
       id2str_.resize(id + 1);
+    resizeStr2Id(str2idEntries_ + 1);
+
+    // the id belongs to another word already: that word keeps resolving to it as an alias, and
+    // str becomes the string of the id, like with repeated assignments to a map
+    const std::string& previous = id2str_[id];
+    if(!previous.empty() && previous != str) {
+      size_t previousSlot = findSlot(previous.data(), previous.size());
+      if(str2id_[previousSlot] == id) {
+        aliases_.emplace_back(previous, id);
+        str2id_[previousSlot] = ALIAS | (Word)(aliases_.size() - 1);
+      }
+    }
     id2str_[id] = str;
+
+    size_t slot = findSlot(str.data(), str.size());
+    if(str2id_[slot] == NO_ID)
+      str2idEntries_++;
+    str2id_[slot] = id;
     return id;
   };
 };
 
+const Word DefaultVocab::NO_ID;
+const Word DefaultVocab::ALIAS;
+
 Ptr<VocabBase> createDefaultVocab() {
   return New<DefaultVocab>();
 }
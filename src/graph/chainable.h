@@ -61,6 +61,8 @@ public:
 
   virtual size_t allocate() = 0;
   virtual void free() = 0;
+  virtual void freeValue() {}
+  virtual bool isView() { return false; }
   virtual void init() = 0;
   virtual void init_dependent() {}
   virtual void set_zero_adjoint() {}
@@ -1,10 +1,146 @@
 #include "graph/expression_graph.h"
+#include <algorithm>
 #include <sstream>
 
 #include "tensors/tensor_operators.h"
 
 namespace marian {
 
+GradientBuckets::GradientBuckets(Ptr<Parameters> params,
+                                 const std::list<Expr>& nodesBackward,
+                                 size_t bucketSize,
+                                 const ReadyFunc& ready)
+    : ready_(ready) {
+  const float* base = params->grads()->data();
+
+  // parameters ordered by their position in gradient memory
+  std::vector<std::pair<size_t, Expr>> offsets;
+  for(auto p : *params)
+    offsets.emplace_back((size_t)(p->grad()->data() - base), p);
+  std::sort(offsets.begin(), offsets.end(), [](const std::pair<size_t, Expr>& a,
+                                                const std::pair<size_t, Expr>& b) {
+    return a.first < b.first;
+  });
+
+  std::unordered_map<Expr, size_t> bucketOf;
+  bounds_.push_back(0);
+  for(auto& o : offsets) {
+    if(o.first - bounds_.back() >= bucketSize)
+      bounds_.push_back(o.first);
+    bucketOf[o.second] = bounds_.size() - 1;
+  }
+  bounds_.push_back(params->grads()->size());
+  pending_.resize(bounds_.size() - 1, 0);
+
+  // last consumer of each parameter in backward order, nodesBackward is processed from the back
+  std::unordered_map<Expr, Expr> lastConsumer;
+  for(auto it = nodesBackward.rbegin(); it != nodesBackward.rend(); ++it)
+    for(auto& child : (*it)->children())
+      if(bucketOf.count(child))
+        lastConsumer[child] = *it;
+
+  for(auto& pc : lastConsumer) {
+    size_t bucket = bucketOf[pc.first];
+    pending_[bucket]++;
+    finalizes_[pc.second].push_back(bucket);
+  }
+}
+
+void GradientBuckets::start() {
+  for(size_t bucket = 0; bucket < pending_.size(); ++bucket)
+    if(pending_[bucket] == 0)
+      ready_(bounds_[bucket], bounds_[bucket + 1]);
+}
+
+void GradientBuckets::done(const Expr& node) {
+  auto it = finalizes_.find(node);
+  if(it == finalizes_.end())
+    return;
+  for(size_t bucket : it->second)
+    release(bucket);
+}
+
+void GradientBuckets::release(size_t bucket) {
+  if(--pending_[bucket] == 0)
+    ready_(bounds_[bucket], bounds_[bucket + 1]);
+}
+
+void ExpressionGraph::planCheckpoints() {
+  for(auto& c : checkpoints_)
+    segmentEnds_.push_back(c->getId());
+  checkpoints_.clear();
+  std::sort(segmentEnds_.begin(), segmentEnds_.end());
+  segmentEnds_.erase(std::unique(segmentEnds_.begin(), segmentEnds_.end()), segmentEnds_.end());
+  recompute_.resize(segmentEnds_.size());
+
+  // values that are needed outside of their own segment have to be kept, as well as roots
+  std::unordered_set<Expr> consumed;
+  std::unordered_set<Expr> keep(topNodes_.begin(), topNodes_.end());
+  for(auto& v : nodesForward_) {
+    size_t segment = segmentOf(v);
+    for(auto& child : v->children()) {
+      consumed.insert(child);
+      if(segmentOf(child) != segment)
+        keep.insert(child);
+    }
+  }
+
+  // a view reads the memory of its child, so the child has to be kept as long as the view
+  for(auto it = nodesForward_.rbegin(); it != nodesForward_.rend(); ++it)
+    if((*it)->isView() && keep.count(*it))
+      for(auto& child : (*it)->children())
+        keep.insert(child);
+
+  for(auto& v : nodesForward_) {
+    size_t segment = segmentOf(v);
+    if(segment == segmentEnds_.size())
+      continue;
+    segmentLast_[v] = segment;
+    // only operations can be recomputed from their children, leaves are kept
+    if(v->getId() != segmentEnds_[segment] && !v->children().empty() && !v->memoize()
+       && consumed.count(v) && !keep.count(v))
+      recompute_[segment].push_back(v);
+  }
+
+  // keep only the last node of each segment
+  std::vector<bool> seen(segmentEnds_.size(), false);
+  for(auto it = nodesForward_.rbegin(); it != nodesForward_.rend(); ++it) {
+    auto found = segmentLast_.find(*it);
+    if(found == segmentLast_.end())
+      continue;
+    if(seen[found->second])
+      segmentLast_.erase(found);
+    else
+      seen[found->second] = true;
+  }
+}
+
+size_t ExpressionGraph::segmentOf(const Expr& node) {
+  return std::lower_bound(segmentEnds_.begin(), segmentEnds_.end(), node->getId())
+         - segmentEnds_.begin();
+}
+
+void ExpressionGraph::freeSegment(const Expr& node) {
+  auto it = segmentLast_.find(node);
+  if(it == segmentLast_.end())
+    return;
+  for(auto& v : recompute_[it->second])
+    v->freeValue();
+  segmentLast_.erase(it);
+}
+
+void ExpressionGraph::recomputeSegment(const Expr& node) {
+  size_t segment = segmentOf(node);
+  if(segment == segmentEnds_.size() || recompute_[segment].empty())
+    return;
+  for(auto& v : recompute_[segment]) {
+    v->allocate();
+    v->init();
+    v->forward();
+  }
+  recompute_[segment].clear();
+}
+
 ExpressionGraph::ExpressionGraph(bool inference, bool optimized)
     : inferenceOnly_(inference), optimized_(optimized), backend_(nullptr) {}
 
@@ -38,8 +174,9 @@ void ExpressionGraph::save(std::vector<io::Item>& ioItems) {
         pName = pName.substr(namespace_.size() + 2);
     }
 
-    ABORT_IF(p.second->val()->type() != Type::float32,
-             "Only float32 supported at the moment");
+    ABORT_IF(p.second->val()->type() != Type::float32
+                 && p.second->val()->type() != Type::bfloat16,
+             "Only float32 and bfloat16 supported at the moment");
 
     Tensor val = p.second->val();
 
@@ -11,7 +11,10 @@
 #include "graph/node_operators.h"
 #include "graph/parameters.h"
 
+#include <functional>
+#include <list>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace marian {
@@ -72,7 +75,7 @@ public:
     size_t hash = node->hash();
     // memoize constant nodes that are not parameters
     // parameters are already memoized in the graph itself
-    if(node->type() != "param" && node->memoize()) {
+    if(node->memoize() && node->type() != "param") {
       auto it = longterm_->find(hash);
       if(it != longterm_->end()) {
         for(auto found : it->second) {
@@ -111,6 +114,38 @@ public:
   void clearLongtermMemory() { longterm_->clear(); }
 };
 
+/**
+ * @brief Tracks during a backward step which parameter gradients are final.
+ *
+ * The gradient memory of all parameters is divided into contiguous buckets of at least
+ * bucketSize elements, split at parameter boundaries. A parameter's gradient is final once the
+ * last node that consumes it (in backward order) has run its backward step. As soon as this is
+ * the case for all parameters in a bucket, ready(begin, end) is called with the bucket's element
+ * range in params()->grads(), e.g. to start communicating it while backward goes on.
+ */
+class GradientBuckets {
+public:
+  typedef std::function<void(size_t /*begin*/, size_t /*end*/)> ReadyFunc;
+
+  GradientBuckets(Ptr<Parameters> params,
+                  const std::list<Expr>& nodesBackward,
+                  size_t bucketSize,
+                  const ReadyFunc& ready);
+
+  // signals buckets whose parameters are not used by any node in this step
+  void start();
+  // call after node has run its backward step
+  void done(const Expr& node);
+
+private:
+  ReadyFunc ready_;
+  std::vector<size_t> bounds_;  // bucket i is [bounds_[i], bounds_[i+1])
+  std::vector<size_t> pending_; // [bucket] number of gradients that are not final yet
+  std::unordered_map<Expr, std::vector<size_t>> finalizes_; // node -> buckets of parameters it consumes last
+
+  void release(size_t bucket);
+};
+
 class ExpressionGraph : public std::enable_shared_from_this<ExpressionGraph> {
 private:
   size_t count_{0};
@@ -138,6 +173,20 @@ private:
 
   bool throwNaN_{false};
 
+  size_t gradientBucketSize_{0};
+  GradientBuckets::ReadyFunc gradientsReady_;
+
+  // Activation checkpointing, see checkpoint()
+  std::vector<Expr> checkpoints_;
+  std::vector<size_t> segmentEnds_;          // [segment] id of its checkpoint, ascending
+  std::vector<std::vector<Expr>> recompute_; // [segment] nodes whose values are freed, in forward order
+  std::unordered_map<Expr, size_t> segmentLast_; // last node of a segment in forward order -> segment
+
+  void planCheckpoints();
+  size_t segmentOf(const Expr& node);
+  void freeSegment(const Expr& node);
+  void recomputeSegment(const Expr& node);
+
 protected:
   // Delete, copy and move constructors
   ExpressionGraph(const ExpressionGraph&) = delete;
@@ -223,6 +272,9 @@ public:
     // @TODO: check if allocation works properly
     tensors_->clearShorttermMemory();
 
+    if(!checkpoints_.empty() && !inferenceOnly_)
+      planCheckpoints();
+
     while(!nodesForward_.empty()) {
       auto v = nodesForward_.front();
       v->allocate();
@@ -237,6 +289,9 @@ public:
         std::cerr << v->val()->debug() << std::endl;
       }
 
+      if(!segmentLast_.empty())
+        freeSegment(v);
+
       if(inferenceOnly_)
         v->children().clear();
       nodesForward_.pop_front();
@@ -270,10 +325,19 @@ public:
 
     tensors_->clearShorttermMemory();
 
+    UPtr<GradientBuckets> buckets;
+    if(gradientsReady_) {
+      buckets.reset(new GradientBuckets(params_, nodesBackward_, gradientBucketSize_, gradientsReady_));
+      buckets->start();
+    }
+
     while(!nodesBackward_.empty()) {
       auto v = nodesBackward_.back();
       nodesBackward_.pop_back();
 
+      if(!recompute_.empty())
+        recomputeSegment(v);
+
       for(auto&& child : v->children()) {
         if(child->trainable() && child->type() != "param")
           child->set_zero_adjoint();
@@ -289,10 +353,44 @@ public:
         std::cerr << v->grad()->debug() << std::endl;
       }
 
+      if(buckets)
+        buckets->done(v);
+
       v->children().clear();
     }
   }
 
+  /**
+   * @brief Marks node as a checkpoint for activation checkpointing, e.g. the output of a
+   * transformer layer, and returns it.
+   *
+   * The nodes added up to a checkpoint (after the previous one) form a segment. During training,
+   * forward() frees the values of the operations in a segment as soon as the segment has been
+   * computed, apart from the checkpoint itself and values that are used outside of the segment.
+   * backward() recomputes them before it runs the backward steps of the segment, so a second
+   * forward pass through the segment is traded for activation memory. Parameters and constants
+   * are never freed, so random values such as dropout masks are the same in both passes.
+   * Checkpoints are ignored during inference.
+   */
+  Expr checkpoint(Expr node) {
+    if(!inferenceOnly_)
+      checkpoints_.push_back(node);
+    return node;
+  }
+
+  /**
+   * @brief Sets a function that backward() calls for each bucket of about bucketSize gradient
+   * elements as soon as all gradients in it are final (see GradientBuckets). Pass nullptr to
+   * remove it.
+   *
+   * The function is called from the thread that runs backward(). Note that on GPUs the backward
+   * kernels may still be running when it is called.
+   */
+  void setGradientsReadyCallback(size_t bucketSize, const GradientBuckets::ReadyFunc& ready) {
+    gradientBucketSize_ = bucketSize;
+    gradientsReady_ = ready;
+  }
+
   std::string graphviz() {
     std::stringstream ss;
     ss << "digraph ExpressionGraph {" << std::endl;
@@ -316,10 +414,13 @@ public:
     dot.close();
   }
 
+  // value_type is only used when the parameter is created, e.g. when loading bfloat16 weights
+  // for CPU inference. Model code always asks for float32 parameters.
   Expr param(const std::string& pname,
              const Shape& shape,
              const NodeInitializer& init,
-             bool fixed = false) {
+             bool fixed = false,
+             Type value_type = Type::float32) {
     std::string name = pname;
     if(!namespace_.empty())
       name = namespace_ + "::" + name;
@@ -349,7 +450,7 @@ public:
     ABORT_IF(get(name), "Non-parameter with name '{}' already exists", name);
 
     // create parameter node (adds to tape)
-    p = Expression<ParamNode>(shared_from_this(), shape, init, fixed);
+    p = Expression<ParamNode>(shared_from_this(), shape, init, fixed, value_type);
 
     // set name and id and add to list of parameters
     p->set_name(name);
@@ -416,12 +517,23 @@ public:
       nodesForward_.push_back(node);
 
       // record in backward graph if training, and keep track of roots
-      if(!inferenceOnly_ && node->trainable()) {
-        nodesBackward_.push_back(node);
-        topNodes_.insert(node); // opportunistically record all new nodes as roots (gets removed once consumed)
+      // (roots are only needed for backward(), so skip the bookkeeping during inference)
+      if(!inferenceOnly_) {
+        if(node->trainable()) {
+          nodesBackward_.push_back(node);
+          topNodes_.insert(node); // opportunistically record all new nodes as roots (gets removed once consumed)
+        }
+        for(auto child : node->children())
+          topNodes_.erase(child); // this child is consumed and therefore not a root
       }
+
+      // bfloat16 parameters can only be read by dedicated products, see tensors/cpu/bf16.h
       for(auto child : node->children())
-        topNodes_.erase(child); // this child is consumed and therefore not a root
+        ABORT_IF(child->value_type() == Type::bfloat16
+                     && node->type().find("Bf16") == std::string::npos,
+                 "Parameter '{}' is stored as bfloat16, which operation '{}' does not support",
+                 child->name(),
+                 node->type());
 
       return node;
     }
@@ -453,6 +565,11 @@ public:
 
     topNodes_.clear();
 
+    checkpoints_.clear();
+    segmentEnds_.clear();
+    recompute_.clear();
+    segmentLast_.clear();
+
     tensors_->clear();
   }
 
@@ -471,7 +588,7 @@ public:
       // skip over special parameters starting with "special:"
       if(pName.substr(0, 8) == "special:")
         continue;
-      param(pName, item.shape, inits::from_item(item));
+      param(pName, item.shape, inits::from_item(item), /*fixed=*/false, item.type);
     }
     if(markReloaded)
       setReloaded(true);
@@ -509,7 +626,7 @@ public:
     save(ioItems);
     if(!meta.empty())
       io::addMetaToItems(meta, "special:model.yml", ioItems);
-    io::saveItems(name, ioItems);
+    io::saveItems(name, std::move(ioItems));
 
     // LOG(info, "Saved {} items.", ioItems.size());
   }
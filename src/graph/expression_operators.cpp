@@ -6,6 +6,7 @@
 #include "graph/node_operators_unary.h"
 
 #include "graph/auto_tuner.h"
+#include "tensors/cpu/bf16.h"
 #include "tensors/cpu/int16.h"
 
 namespace marian {
@@ -271,6 +272,13 @@ Expr dot(Expr a, Expr b, bool transA, bool transB, float scale) {
   auto device = a->graph()->getDeviceId().type;
   float clipValue = a->graph()->getBackend()->getClip();
 
+  // Weights stored as bfloat16 (see marian-conv --bf16) have their own CPU product,
+  // activations stay float32.
+  if(b->value_type() == Type::bfloat16) {
+    ABORT_IF(device != DeviceType::cpu, "bfloat16 parameters are only supported for CPU inference");
+    return cpu::bf16::dot(clip(a, clipValue), b, transA, transB, scale);
+  }
+
   // Currently only true when command line options
   // --optimize --cpu-thread=N with N > 0 are set.
   if(a->graph()->isOptimized() && device == DeviceType::cpu) {
@@ -296,6 +304,11 @@ Expr affine(Expr a, Expr b, Expr bias, bool transA, bool transB, float scale) {
 
   float clipValue = a->graph()->getBackend()->getClip();
 
+  if(b->value_type() == Type::bfloat16) {
+    ABORT_IF(device != DeviceType::cpu, "bfloat16 parameters are only supported for CPU inference");
+    return cpu::bf16::affine(clip(a, clipValue), b, bias, transA, transB, scale);
+  }
+
   if(a->graph()->isOptimized() && device == DeviceType::cpu) {
     bool autotune = true;
     if(autotune) {
@@ -475,6 +488,17 @@ Expr layerNorm(Expr x,
   return Expression<LayerNormalizationOp>(nodes, eps);
 }
 
+Expr layerNormResidual(Expr x,
+                       Expr residual,
+                       Expr gamma,
+                       Expr beta /*= nullptr*/,
+                       float eps /*= 1e-9*/) {
+  std::vector<Expr> nodes = {x, residual, gamma};
+  if(beta)
+    nodes.push_back(beta);
+  return Expression<LayerNormalizationResidualOp>(nodes, eps);
+}
+
 Expr highway(Expr y, Expr x, Expr t) {
   std::vector<Expr> nodes = {y, x, t};
   return Expression<HighwayNodeOp>(nodes);
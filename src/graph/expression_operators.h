@@ -146,6 +146,8 @@ Expr sqrt(Expr a, float eps = 0.f);
 Expr square(Expr a);
 
 Expr layerNorm(Expr x, Expr gamma, Expr beta = nullptr, float eps = 1e-9);
+// fused layerNorm(x + residual, gamma, beta, eps) for skip connections
+Expr layerNormResidual(Expr x, Expr residual, Expr gamma, Expr beta = nullptr, float eps = 1e-9);
 
 Expr highway(Expr y, Expr x, Expr t);
 Expr highway(const std::string prefix, Expr x);
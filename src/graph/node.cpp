@@ -23,6 +23,14 @@ void Node::free() {
   }
 }
 
+void Node::freeValue() {
+  // nodes that do not own their memory (views of other nodes) keep it
+  if(!isView() && val_ && graph()) {
+    graph()->free(val_);
+    val_ = nullptr;
+  }
+}
+
 /**
  * Initialization for backward step of top node
  * in computation graph. Allocates memory and sets gradient
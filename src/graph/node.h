@@ -104,6 +104,12 @@ public:
 
   virtual void free() override;
 
+  // releases the value only, so that allocate() and forward() can recompute it
+  virtual void freeValue() override;
+
+  // true if the value is memory of a child, e.g. for reshape()
+  virtual bool isView() override { return !destroy_; }
+
   virtual void init() override{};
 
   virtual void init_dependent() override;
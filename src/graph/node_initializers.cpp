@@ -138,16 +138,26 @@ NodeInitializer from_word2vec(const std::string& file,
 NodeInitializer from_item(const io::Item& item) {
   if(item.mapped) {
     return [item](Tensor t) {
-      // @TODO: implement other types, for now croak loudly.
       ABORT_IF(t->getBackend()->getDeviceId().type != DeviceType::cpu,
                "Memory mapping only works for CPU tensors");
-      ABORT_IF(!matchType<float>(t->type()),
+      ABORT_IF(t->type() != item.type,
                "Tensor type and type for mapping do not match");
-      auto mp = New<MemoryPiece>((uint8_t*)item.ptr, t->size() * sizeof(float));
+      auto mp = New<MemoryPiece>((uint8_t*)item.ptr, t->size() * sizeOf(item.type));
       t->reset(mp);
     };
   } else {
     return [item](Tensor t) {
+      ABORT_IF(t->type() != item.type,
+               "Tensor type and type for mapping do not match");
+      // bfloat16 weights for CPU inference are stored as they are, see tensors/cpu/bf16.h
+      if(item.type == Type::bfloat16) {
+        ABORT_IF(t->getBackend()->getDeviceId().type != DeviceType::cpu,
+                 "bfloat16 parameters are only supported on CPU");
+        std::copy(item.bytes.begin(),
+                  item.bytes.begin() + t->size() * sizeOf(item.type),
+                  t->data<char>());
+        return;
+      }
       // @TODO: implement other types, for now croak loudly.
       ABORT_IF(!matchType<float>(t->type()),
                "Tensor type and type for mapping do not match");
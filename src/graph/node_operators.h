@@ -45,7 +45,8 @@ struct ParamNode : public Node {
   ParamNode(Ptr<ExpressionGraph> graph,
             const Shape& shape,
             const NodeInitializer& init,
-            bool fixed = false);
+            bool fixed = false,
+            Type value_type = Type::float32);
 
   ~ParamNode() {}
 
@@ -931,6 +931,51 @@ private:
   float eps_;
 };
 
+// layer normalization of (x + residual), avoids materializing the sum of the skip connection
+struct LayerNormalizationResidualOp : public NaryNodeOp {
+public:
+  LayerNormalizationResidualOp(const std::vector<Expr>& nodes, float eps = 1e-9)
+      : NaryNodeOp(nodes, newShape(nodes)), eps_(eps) {}
+
+  Shape newShape(const std::vector<Expr>& nodes) {
+    ABORT_IF(nodes[0]->shape() != nodes[1]->shape(),
+             "Shapes of input {} and residual {} do not match",
+             std::string(nodes[0]->shape()),
+             std::string(nodes[1]->shape()));
+    return nodes[0]->shape();
+  }
+
+  NodeOps forwardOps() override {
+    return {NodeOp(
+        LayerNormalizationResidual(val_,
+                                   child(0)->val(),
+                                   child(1)->val(),
+                                   child(2)->val(),
+                                   (children_.size() == 4) ? child(3)->val() : nullptr,
+                                   eps_))};
+  }
+
+  NodeOps backwardOps() override {
+    return {NodeOp(LayerNormalizationResidualGrad(
+        child(0)->grad(),
+        child(1)->grad(),
+        child(2)->grad(),
+        (children_.size() == 4) ? child(3)->grad() : nullptr,
+        adj_,
+        val_,
+        child(0)->val(),
+        child(1)->val(),
+        child(2)->val(),
+        (children_.size() == 4) ? child(3)->val() : nullptr,
+        eps_))};
+  }
+
+  const std::string type() override { return "layer_normalization_residual"; }
+
+private:
+  float eps_;
+};
+
 struct HighwayNodeOp : public NaryNodeOp {
   HighwayNodeOp(const std::vector<Expr>& nodes) : NaryNodeOp(nodes) {}
 
@@ -22,7 +22,7 @@ protected:
   size_t totalCapacity(Ptr<TensorAllocator> alloc) {
     size_t sum = 0;
     for(auto p : params_) {
-      sum += alloc->capacity(p->shape(), Type::float32);
+      sum += alloc->capacity(p->shape(), p->value_type());
     }
     return sum;
   }
@@ -61,7 +61,7 @@ public:
       vals_->reserveExact(totalCapacity(vals_));
       for(auto p : params_) {
         if(!p->val()) {
-          vals_->allocate(p->val(), p->shape());
+          vals_->allocate(p->val(), p->shape(), p->value_type());
         }
       }
     }
@@ -70,9 +70,14 @@ public:
   virtual void allocateBackward() {
     if(!params_.empty() && grads_->size() == 0) {
       grads_->reserveExact(totalCapacity(grads_));
-      for(auto p : params_)
+      for(auto p : params_) {
+        ABORT_IF(p->value_type() != Type::float32,
+                 "Parameter '{}' of type {} cannot be trained",
+                 p->name(),
+                 p->value_type());
         if(!p->grad())
           grads_->allocate(p->grad(), p->shape());
+      }
     }
   }
 
@@ -103,7 +108,7 @@ public:
       for(auto p : params_) {
         if(!p->val()) {
           p->val() = Tensor(
-              new TensorBase(nullptr, p->shape(), Type::float32, backend_));
+              new TensorBase(nullptr, p->shape(), p->value_type(), backend_));
         }
       }
     }
@@ -173,7 +173,7 @@ public:
     ioItems.back().bytes.emplace_back(0);
 
     io::addMetaToItems(getModelParametersAsString(), "special:model.yml", ioItems);
-    io::saveItems(name, ioItems);
+    io::saveItems(name, std::move(ioItems));
 
     if(saveTranslatorConfig) {
       createAmunConfig(name);
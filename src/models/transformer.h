@@ -13,6 +13,8 @@
 #include "models/transformer_factory.h"
 #include "rnn/constructors.h"
 
+#include <numeric>
+
 namespace marian {
 
 // clang-format off
@@ -33,10 +35,12 @@ protected:
   // It can be accessed by getAlignments(). @TODO: move into a state or return-value object
   std::vector<Expr> alignments_; // [max tgt len or 1][beam depth, max src length, batch size, 1]
 
-  template <typename T> T opt(const std::string& key) const { Ptr<Options> options = options_; return options->get<T>(key); }  // need to duplicate, since somehow using Base::opt is not working
-  // FIXME: that separate options assignment is weird
+  // Options are queried per layer and per decoding step, so their typed values are cached
+  mutable OptionsCache optionsCache_;
+
+  template <typename T> T opt(const std::string& key) const { return optionsCache_.get<T>(*options_, key); }  // need to duplicate, since somehow using Base::opt is not working
 
-  template <typename T> T opt(const std::string& key, const T& def) const { Ptr<Options> options = options_; if (options->has(key)) return options->get<T>(key); else return def; }
+  template <typename T> T opt(const std::string& key, const T& def) const { return optionsCache_.get<T>(*options_, key, def); }
 
   Ptr<ExpressionGraph> graph_;
 
@@ -47,35 +51,68 @@ public:
 
   static Expr transposeTimeBatch(Expr input) { return transpose(input, {0, 2, 1, 3}); }
 
-  Expr addPositionalEmbeddings(Expr input, int start = 0) const {
-    int dimEmb   = input->shape()[-1];
-    int dimWords = input->shape()[-3];
+  // Host-side sinusoidal table, computed once per model and grown on demand. Row p holds the
+  // positional signal for position p, so any [start, start + length) range is a plain row lookup.
+  std::vector<float> positionalTable_; // [max length, dimEmb]
+  int positionalTableDim_{0};
+
+  const std::vector<float>& positionalTable(int dimEmb, int length) {
+    int capacity = positionalTableDim_ == dimEmb ? (int)positionalTable_.size() / dimEmb : 0;
+    if(length <= capacity)
+      return positionalTable_;
+
+    int newCapacity = std::max(length, 2 * capacity);
 
     float num_timescales = (float)dimEmb / 2;
     float log_timescale_increment = std::log(10000.f) / (num_timescales - 1.f);
 
-    std::vector<float> vPos(dimEmb * dimWords, 0);
-    for(int p = start; p < dimWords + start; ++p) {
+    positionalTable_.assign(dimEmb * newCapacity, 0);
+    positionalTableDim_ = dimEmb;
+    for(int p = 0; p < newCapacity; ++p) {
       for(int i = 0; i < num_timescales; ++i) {
         float v = p * std::exp(i * -log_timescale_increment);
-        vPos[(p - start) * dimEmb + i] = std::sin(v);
-        vPos[(p - start) * dimEmb + (int)num_timescales + i] = std::cos(v); // @TODO: is int vs. float correct for num_timescales?
+        positionalTable_[p * dimEmb + i] = std::sin(v);
+        positionalTable_[p * dimEmb + (int)num_timescales + i] = std::cos(v); // @TODO: is int vs. float correct for num_timescales?
       }
     }
+    return positionalTable_;
+  }
+
+  Expr addPositionalEmbeddings(Expr input, int start = 0) {
+    int dimEmb   = input->shape()[-1];
+    int dimWords = input->shape()[-3];
+
+    // The table is uploaded as a single constant per graph and memoized in cache_ (cleared with the
+    // graph), so decoder steps only add a row lookup instead of recomputing and uploading the signal.
+    const auto& vPos = positionalTable(dimEmb, start + dimWords);
+    int maxLength = (int)vPos.size() / dimEmb;
+
+    Expr& table = cache_["positional_table"];
+    if(!table || table->shape()[-2] != maxLength || table->shape()[-1] != dimEmb)
+      table = graph_->constant({maxLength, dimEmb}, inits::from_vector(vPos));
+
+    std::vector<IndexType> positions(dimWords);
+    std::iota(positions.begin(), positions.end(), (IndexType)start);
 
     // shared across batch entries
-    auto signal
-        = graph_->constant({dimWords, 1, dimEmb}, inits::from_vector(vPos));
+    auto signal = reshape(rows(table, positions), {dimWords, 1, dimEmb});
     return input + signal;
   }
 
-  Expr triangleMask(int length) const {
+  // Triangle masks only depend on the target length of the batch and are memoized per graph in
+  // cache_, like the positional table.
+  Expr triangleMask(int length) {
+    Expr& mask = cache_["triangle_mask_" + std::to_string(length)];
+    if(mask)
+      return mask;
+
     // fill triangle mask
     std::vector<float> vMask(length * length, 0);
     for(int i = 0; i < length; ++i)
       for(int j = 0; j <= i; ++j)
         vMask[i * length + j] = 1.f;
-    return graph_->constant({1, length, length}, inits::from_vector(vMask));
+    mask = graph_->constant({1, length, length}, inits::from_vector(vMask));
+    return mask;
   }
 
   // convert multiplicative 1/0 mask to additive 0/-inf log mask, and transpose to match result of bdot() op in Attention()
@@ -137,6 +174,14 @@ public:
     return marian::layerNorm(x, scale, bias, 1e-6f);
   }
 
+  // layerNorm(x + residual) as a single fused operation, uses the same parameters as layerNorm()
+  Expr layerNormResidual(Expr x, Expr residual, std::string prefix, std::string suffix = std::string()) const {
+    int dimModel = x->shape()[-1];
+    auto scale = graph_->param(prefix + "_ln_scale" + suffix, { 1, dimModel }, inits::ones);
+    auto bias  = graph_->param(prefix + "_ln_bias"  + suffix, { 1, dimModel }, inits::zeros);
+    return marian::layerNormResidual(x, residual, scale, bias, 1e-6f);
+  }
+
   Expr preProcess(std::string prefix, std::string ops, Expr input, float dropProb = 0.0f) const {
     auto output = input;
     for(auto op : ops) {
@@ -154,10 +199,17 @@ public:
 
   Expr postProcess(std::string prefix, std::string ops, Expr input, Expr prevInput, float dropProb = 0.0f) const {
     auto output = input;
-    for(auto op : ops) {
+    for(size_t i = 0; i < ops.size(); ++i) {
+      char op = ops[i];
       // dropout
       if(op == 'd')
         output = dropout(output, dropProb);
+      // skip connection followed by layer normalization, fused into one operation
+      else if(op == 'a' && i + 1 < ops.size() && ops[i + 1] == 'n'
+              && output->shape() == prevInput->shape()) {
+        output = layerNormResidual(output, prevInput, prefix);
+        ++i;
+      }
       // skip connection
       else if(op == 'a')
         output = output + prevInput;
@@ -563,6 +615,7 @@ public:
 
     // apply encoder layers
     auto encDepth = opt<int>("enc-depth");
+    bool checkpointing = !inference_ && opt<bool>("transformer-checkpointing", false);
     for(int i = 1; i <= encDepth; ++i) {
       layer = LayerAttention(prefix_ + "_l" + std::to_string(i) + "_self",
                              layer, // query
@@ -571,6 +624,9 @@ public:
                              layerMask);
 
       layer = LayerFFN(prefix_ + "_l" + std::to_string(i) + "_ffn", layer);
+
+      if(checkpointing)
+        layer = graph_->checkpoint(layer);
     }
 
     // restore organization of batch and time steps. This is currently required
@@ -581,7 +637,9 @@ public:
     return New<EncoderState>(context, batchMask, batch);
   }
 
-  void clear() override {}
+  void clear() override {
+    cache_.clear();
+  }
 };
 
 class TransformerState : public DecoderState {
@@ -754,6 +812,24 @@ public:
              tiedLayers.size(),
              decDepth);
 
+    // if training is performed with guided_alignment or if alignment is requested during
+    // decoding or scoring return the attention weights of one head of the chosen layer.
+    // @TODO: maybe allow to return average or max over all heads?
+    int attLayer = -1;
+    if(opt<std::string>("guided-alignment", std::string("none")) != "none" || options_->has("alignment")) {
+      attLayer = decDepth - 1;
+      std::string gaStr = opt<std::string>("transformer-guided-alignment-layer", "last");
+      if(gaStr != "last")
+        attLayer = (int)std::stoull(gaStr) - 1;
+
+      ABORT_IF(attLayer >= decDepth,
+               "Chosen layer for guided attention ({}) larger than number of layers ({})",
+               attLayer + 1, decDepth);
+    }
+
+    std::string layerType = opt<std::string>("transformer-decoder-autoreg", "self-attention");
+    bool checkpointing = !inference_ && opt<bool>("transformer-checkpointing", false);
+
     for(int i = 0; i < decDepth; ++i) {
       std::string layerNo = std::to_string(i + 1);
       if (!tiedLayers.empty())
@@ -764,7 +840,6 @@ public:
         prevDecoderState = prevDecoderStates[i];
 
       // self-attention
-      std::string layerType = opt<std::string>("transformer-decoder-autoreg", "self-attention");
       rnn::State decoderState;
       if(layerType == "self-attention")
         query = DecoderLayerSelfAttention(decoderState, prevDecoderState, prefix_ + "_l" + layerNo + "_self", query, selfMask, startPos);
@@ -785,22 +860,7 @@ public:
           if(j > 0)
             prefix += "_enc" + std::to_string(j + 1);
 
-          // if training is performed with guided_alignment or if alignment is requested during
-          // decoding or scoring return the attention weights of one head of the last layer.
-          // @TODO: maybe allow to return average or max over all heads?
-          bool saveAttentionWeights = false;
-          if(j == 0 && (options_->get("guided-alignment", std::string("none")) != "none" || options_->has("alignment"))) {
-            size_t attLayer = decDepth - 1;
-            std::string gaStr = options_->get<std::string>("transformer-guided-alignment-layer", "last");
-            if(gaStr != "last")
-              attLayer = std::stoull(gaStr) - 1;
-
-            ABORT_IF(attLayer >= decDepth,
-                     "Chosen layer for guided attention ({}) larger than number of layers ({})",
-                     attLayer + 1, decDepth);
-
-            saveAttentionWeights = i == attLayer;
-          }
+          bool saveAttentionWeights = j == 0 && i == attLayer;
 
           query = LayerAttention(prefix,
                                  query,
@@ -816,6 +876,9 @@ public:
       decoderStates.push_back(decoderState);
 
       query = LayerFFN(prefix_ + "_l" + layerNo + "_ffn", query); // [-4: beam depth=1, -3: batch size, -2: max length, -1: vector dim]
+
+      if(checkpointing)
+        query = graph_->checkpoint(query);
     }
 
     auto decoderContext = transposeTimeBatch(query); // [-4: beam depth=1, -3: max length, -2: batch size, -1: vector dim]
@@ -827,7 +890,7 @@ public:
 
     // return unormalized(!) probabilities
     Ptr<DecoderState> nextState;
-    if (opt<std::string>("transformer-decoder-autoreg", "self-attention") == "rnn") {
+    if (layerType == "rnn") {
       nextState = New<DecoderState>(
           decoderStates, logits, state->getEncoderStates(), state->getBatch());
     } else {
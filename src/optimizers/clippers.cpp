@@ -11,8 +11,13 @@ void Elementwise::clip(Tensor t) {
 
 void Norm::clip(Tensor t) {
   using namespace functional;
+  float factor = scale(t);
+  if(factor != 1.f)
+    Element(_1 = factor * _1, t);
+}
+
+float Norm::scale(Tensor t) {
   float l2Norm = L2Norm(t);
-  if(l2Norm >= c_)
-    Element(_1 = (c_ / l2Norm) * _1, t);
+  return l2Norm >= c_ ? c_ / l2Norm : 1.f;
 }
 }  // namespace marian
@@ -16,6 +16,13 @@ namespace marian {
 class ClipperBase {
 public:
   virtual void clip(Tensor) = 0;
+
+  // Returns a factor that the optimizer applies to the gradient in its update instead of
+  // modifying it here. Clippers that cannot be expressed as a factor clip in place and return 1.
+  virtual float scale(Tensor t) {
+    clip(t);
+    return 1.f;
+  }
 };
 
 typedef std::shared_ptr<ClipperBase> ClipperPtr;
@@ -35,6 +42,7 @@ public:
   Norm(float c = 1.0) : c_(c) {}
 
   void clip(Tensor t) override;
+  float scale(Tensor t) override;
 
 private:
   float c_;
@@ -5,18 +5,41 @@
 
 namespace marian {
 
-void Sgd::updateImpl(Tensor params, Tensor grads) {
+void OptimizerBase::updateAvgParams(Tensor paramsAvg, Tensor params, float avgDecay) {
+  if(!paramsAvg)
+    return;
+
+  using namespace functional;
+  Element(_1 = ((1.f - avgDecay) * _1) + (avgDecay * _2), paramsAvg, params);
+}
+
+void Sgd::updateImpl(Tensor params,
+                     Tensor grads,
+                     float gradScale,
+                     Tensor paramsAvg,
+                     float avgDecay) {
+  if(params->getBackend()->getDeviceId().type == DeviceType::cpu) {
+    cpu::SgdUpdate(params, grads, eta_, gradScale, paramsAvg, avgDecay);
+    return;
+  }
+
   using namespace functional;
-  Element(_1 -= eta_ * _2,
+  Element(_1 -= (eta_ * gradScale) * _2,
           params,
           grads);
 
+  updateAvgParams(paramsAvg, params, avgDecay);
+
   params->getBackend()->synchronize();
 }
 
 // Aagrad
 
-void Adagrad::updateImpl(Tensor params, Tensor grads) {
+void Adagrad::updateImpl(Tensor params,
+                         Tensor grads,
+                         float gradScale,
+                         Tensor paramsAvg,
+                         float avgDecay) {
   if(!alloc_)
     alloc_ = New<TensorAllocator>(params->getBackend());
 
@@ -27,8 +50,17 @@ void Adagrad::updateImpl(Tensor params, Tensor grads) {
     gt_->set(0.f);
   }
 
+  // on CPU, a fused kernel makes one pass over all tensors instead of two
+  if(params->getBackend()->getDeviceId().type == DeviceType::cpu) {
+    cpu::AdagradUpdate(params, grads, gt_, eta_, eps_, gradScale, paramsAvg, avgDecay);
+    return;
+  }
+
   using namespace functional;
 
+  if(gradScale != 1.f)
+    Element(_1 = gradScale * _1, grads);
+
   Element(_1 += (_2 * _2), gt_, grads);
 
   Element(_1 -= (eta_ / (sqrt(_2) + eps_)) * _3,
@@ -36,6 +68,8 @@ void Adagrad::updateImpl(Tensor params, Tensor grads) {
           gt_,
           grads);
 
+  updateAvgParams(paramsAvg, params, avgDecay);
+
   params->getBackend()->synchronize();
 }
 
@@ -111,7 +145,9 @@ void Adagrad::save(const std::string& name,
   std::copy(
       (char*)vGt.data(), (char*)vGt.data() + vGt.size(), item.bytes.begin());
 
-  io::saveItems(name, {item});
+  std::vector<io::Item> items;
+  items.push_back(std::move(item));
+  io::saveItems(name, std::move(items));
 }
 
 void Adagrad::resetStats() {
@@ -121,7 +157,11 @@ void Adagrad::resetStats() {
 
 // Adam
 
-void Adam::updateImpl(Tensor params, Tensor grads) {
+void Adam::updateImpl(Tensor params,
+                      Tensor grads,
+                      float gradScale,
+                      Tensor paramsAvg,
+                      float avgDecay) {
   if(!alloc_)
     alloc_ = New<TensorAllocator>(params->getBackend());
 
@@ -139,8 +179,18 @@ void Adam::updateImpl(Tensor params, Tensor grads) {
   float denom1 = 1 - (float)std::pow(beta1_, t_);
   float denom2 = 1 - (float)std::pow(beta2_, t_);
 
+  // on CPU, a fused kernel makes one pass over all tensors instead of three
+  if(params->getBackend()->getDeviceId().type == DeviceType::cpu) {
+    cpu::AdamUpdate(params, grads, mt_, vt_, eta_, beta1_, beta2_, denom1, denom2, eps_, w_, gradScale,
+                    paramsAvg, avgDecay);
+    return;
+  }
+
   using namespace functional;
 
+  if(gradScale != 1.f)
+    Element(_1 = gradScale * _1, grads);
+
   Element(_1 = (beta1_ * _1) + ((1 - beta1_) * _2), mt_, grads);
   Element(_1 = (beta2_ * _1) + ((1 - beta2_) * (_2 * _2)), vt_, grads);
 
@@ -152,6 +202,8 @@ void Adam::updateImpl(Tensor params, Tensor grads) {
           mt_,
           vt_);
 
+  updateAvgParams(paramsAvg, params, avgDecay);
+
   params->getBackend()->synchronize();
 }
 
@@ -258,7 +310,10 @@ void Adam::save(const std::string& name,
   std::copy(
       (char*)vVt.data(), (char*)vVt.data() + vVt.size(), itemVt.bytes.begin());
 
-  io::saveItems(name, {itemMt, itemVt});
+  std::vector<io::Item> items;
+  items.push_back(std::move(itemMt));
+  items.push_back(std::move(itemVt));
+  io::saveItems(name, std::move(items));
 }
 
 void Adam::resetStats() {
@@ -28,12 +28,16 @@ public:
     update(p, g);
   }
 
-  void update(Tensor params, Tensor grads) {
-    if(clipper_)
-      clipper_->clip(grads);
+  // If paramsAvg is given, it is updated with the new parameter values as
+  // paramsAvg = (1 - avgDecay) * paramsAvg + avgDecay * params (exponential smoothing). On CPU
+  // this happens in the same pass over memory as the update of params.
+  void update(Tensor params, Tensor grads, Tensor paramsAvg = nullptr, float avgDecay = 0.f) {
+    // gradient clipping by norm is applied as a factor inside the update, which saves a pass
+    // over the gradient
+    float gradScale = clipper_ ? clipper_->scale(grads) : 1.f;
 
     // In case we want to add a multiply factor to our learning rate
-    updateImpl(params, grads);
+    updateImpl(params, grads, gradScale, paramsAvg, avgDecay);
   }
 
   virtual void init(TrainingState& state) override {
@@ -78,7 +82,16 @@ public:
                     bool /*isMainProcess*/ = true) {}
 
 protected:
-  virtual void updateImpl(Tensor params, Tensor grads) = 0;
+  // updates params with grads * gradScale, and paramsAvg (if not null) with the new params
+  virtual void updateImpl(Tensor params,
+                          Tensor grads,
+                          float gradScale,
+                          Tensor paramsAvg,
+                          float avgDecay)
+      = 0;
+
+  // separate smoothing pass for backends without fused update kernels
+  void updateAvgParams(Tensor paramsAvg, Tensor params, float avgDecay);
   virtual void parseParams(const std::vector<float>& params) = 0;
   virtual void resetStats() = 0;
 
@@ -97,7 +110,11 @@ public:
       : OptimizerBase(eta, clipper) {}
 
 private:
-  void updateImpl(Tensor params, Tensor grads) override;
+  void updateImpl(Tensor params,
+                  Tensor grads,
+                  float gradScale,
+                  Tensor paramsAvg,
+                  float avgDecay) override;
 
   virtual void parseParams(const std::vector<float>& /*params*/) override {}
   virtual void resetStats() override {}
@@ -123,7 +140,11 @@ public:
             bool /*isMainProcess*/ = true) override;
 
 private:
-  void updateImpl(Tensor params, Tensor grads) override;
+  void updateImpl(Tensor params,
+                  Tensor grads,
+                  float gradScale,
+                  Tensor paramsAvg,
+                  float avgDecay) override;
   void resetStats() override;
 
   void parseParams(const std::vector<float>& params) override {
@@ -156,7 +177,11 @@ public:
             bool isMainProcess = true) override;
 
 private:
-  void updateImpl(Tensor params, Tensor grads) override;
+  void updateImpl(Tensor params,
+                  Tensor grads,
+                  float gradScale,
+                  Tensor paramsAvg,
+                  float avgDecay) override;
   void resetStats() override;
 
   virtual void parseParams(const std::vector<float>& params) override {
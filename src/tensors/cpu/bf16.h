@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/hash.h"
+#include "graph/expression_graph.h"
+#include "graph/node.h"
+
+#include <cstring>
+
+namespace marian {
+namespace cpu {
+namespace bf16 {
+
+// bfloat16 is the upper half of a float32, with the same exponent range and 8 bits of mantissa.
+// Weight matrices are stored in this format to halve model memory and bandwidth for CPU
+// inference, while activations and accumulation remain float32.
+
+static inline float toFloat(uint16_t value) {
+  uint32_t bits = (uint32_t)value << 16;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+// rounds to nearest even, keeps NaNs quiet
+static inline uint16_t fromFloat(float f) {
+  uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  if((bits & 0x7FFFFFFF) > 0x7F800000)
+    return (uint16_t)((bits >> 16) | 0x40);
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return (uint16_t)(bits >> 16);
+}
+
+// C = scale * op(A) * op(B) (+ bias) with float32 A and C, bfloat16 B. B is converted to
+// float32 in panels of columns right before each panel is multiplied.
+void ProdBf16(marian::Tensor C,
+              const marian::Tensor A,
+              const marian::Tensor B,
+              const marian::Tensor bias,
+              bool transA,
+              bool transB,
+              float scale);
+
+class DotNodeOp : public NaryNodeOp {
+private:
+  bool transA_;
+  bool transB_;
+  float scalar_;
+
+public:
+  DotNodeOp(const std::vector<Expr>& nodes, bool transA, bool transB, float scalar)
+      : NaryNodeOp(nodes, newShape(nodes[0], nodes[1], transA, transB)),
+        transA_(transA),
+        transB_(transB),
+        scalar_(scalar) {
+    ABORT_IF(nodes[0]->value_type() != Type::float32,
+             "bfloat16 products require a float32 left operand");
+  }
+
+  Shape newShape(Expr a, Expr b, bool transA, bool transB) {
+    auto shapeA = a->shape();
+    if(transA) {
+      shapeA.set(-2, a->shape()[-1]);
+      shapeA.set(-1, a->shape()[-2]);
+    }
+
+    auto shapeB = b->shape();
+    if(transB) {
+      shapeB.set(-2, b->shape()[-1]);
+      shapeB.set(-1, b->shape()[-2]);
+    }
+
+    Shape outShape = shapeA;
+    outShape.set(-1, shapeB[-1]);
+    ABORT_IF(shapeA[-1] != shapeB[-2],
+             "matrix product requires dimensions to match");
+    return outShape;
+  }
+
+  NodeOps forwardOps() override {
+    Tensor bias = children().size() > 2 ? child(2)->val() : nullptr;
+    return {NodeOp(ProdBf16(val_, child(0)->val(), child(1)->val(), bias, transA_, transB_, scalar_))};
+  }
+
+  NodeOps backwardOps() override {
+    ABORT("Only used for inference");
+    return {NodeOp(0)};
+  }
+
+  const std::string type() override { return children().size() > 2 ? "affineBf16" : "dotBf16"; }
+
+  virtual size_t hash() override {
+    if(!hash_) {
+      size_t seed = NaryNodeOp::hash();
+      util::hash_combine(seed, transA_);
+      util::hash_combine(seed, transB_);
+      util::hash_combine(seed, scalar_);
+      hash_ = seed;
+    }
+    return hash_;
+  }
+
+  virtual bool equal(Expr node) override {
+    if(!NaryNodeOp::equal(node))
+      return false;
+    auto cnode = std::dynamic_pointer_cast<DotNodeOp>(node);
+    if(!cnode)
+      return false;
+    return transA_ == cnode->transA_ && transB_ == cnode->transB_ && scalar_ == cnode->scalar_;
+  }
+};
+
+static inline Expr dot(Expr a, Expr b, bool transA, bool transB, float scalar) {
+  std::vector<Expr> nodes = {a, b};
+  return Expression<cpu::bf16::DotNodeOp>(nodes, transA, transB, scalar);
+}
+
+static inline Expr affine(Expr a, Expr b, Expr bias, bool transA, bool transB, float scalar) {
+  std::vector<Expr> nodes = {a, b, bias};
+  return Expression<cpu::bf16::DotNodeOp>(nodes, transA, transB, scalar);
+}
+
+}  // namespace bf16
+}  // namespace cpu
+}  // namespace marian
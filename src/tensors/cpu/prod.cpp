@@ -16,6 +16,7 @@
 #endif
 
 #include "sharp/int_gemm.h"
+#include "tensors/cpu/bf16.h"
 
 namespace marian {
 
@@ -167,5 +168,71 @@ void ProdWithBias(marian::Tensor C,
   cpu::int16::AddBias(C, bias);
 }
 
+void bf16::ProdBf16(marian::Tensor C,
+                    const marian::Tensor A,
+                    const marian::Tensor B,
+                    const marian::Tensor bias,
+                    bool transA,
+                    bool transB,
+                    float scale) {
+#if BLAS_FOUND
+  ABORT_IF(B->type() != Type::bfloat16, "ProdBf16 expects a bfloat16 right operand");
+
+  int m = A->shape().elements() / A->shape()[-1];
+  int k = A->shape().back();
+  if(transA)
+    std::swap(m, k);
+
+  int n = B->shape()[-1];
+  if(transB)
+    n = B->shape().elements() / B->shape()[-1];
+
+  int lda = A->shape()[-1];
+  int ldc = n;
+
+  // Columns of op(B) are converted in panels that stay in cache while they are multiplied with
+  // all rows of A. For transB, a panel is a contiguous block of rows of B.
+  const int PANEL = 256;
+  const uint16_t* b = B->data<uint16_t>();
+  thread_local std::vector<float> panel;
+  for(int j0 = 0; j0 < n; j0 += PANEL) {
+    int nb = std::min(PANEL, n - j0);
+    panel.resize((size_t)k * nb);
+    if(transB) {
+      const uint16_t* src = b + (size_t)j0 * k;
+      for(size_t i = 0; i < (size_t)nb * k; ++i)
+        panel[i] = bf16::toFloat(src[i]);
+    } else {
+      for(int r = 0; r < k; ++r) {
+        const uint16_t* src = b + (size_t)r * n + j0;
+        float* dst = panel.data() + (size_t)r * nb;
+        for(int j = 0; j < nb; ++j)
+          dst[j] = bf16::toFloat(src[j]);
+      }
+    }
+
+    sgemm(transA,
+          transB,
+          m,
+          nb,
+          k,
+          scale,
+          A->data(),
+          lda,
+          panel.data(),
+          transB ? k : nb,
+          0.f,
+          C->data() + j0,
+          ldc);
+  }
+
+  if(bias)
+    cpu::int16::AddBias(C, bias);
+#else
+  C; A; B; bias; transA; transB; scale;
+  ABORT("You need to compile with MKL in order to use the CPU version");
+#endif
+}
+
 }  // namespace cpu
 }  // namespace marian
@@ -742,6 +742,88 @@ float L2Norm(Tensor in) {
   return std::sqrt(sum);
 }
 
+void SgdUpdate(Tensor params_,
+               const Tensor grads_,
+               float eta,
+               float gradScale,
+               Tensor paramsAvg_,
+               float avgDecay) {
+  float* params = params_->data();
+  const float* grads = grads_->data();
+  float* avg = paramsAvg_ ? paramsAvg_->data() : nullptr;
+  size_t size = params_->size();
+
+#pragma omp parallel for simd
+  for(size_t i = 0; i < size; ++i) {
+    float p = params[i] - (eta * gradScale) * grads[i];
+    params[i] = p;
+    if(avg)
+      avg[i] = ((1.f - avgDecay) * avg[i]) + (avgDecay * p);
+  }
+}
+
+void AdamUpdate(Tensor params_,
+                const Tensor grads_,
+                Tensor mt_,
+                Tensor vt_,
+                float eta,
+                float beta1,
+                float beta2,
+                float denom1,
+                float denom2,
+                float eps,
+                float w,
+                float gradScale,
+                Tensor paramsAvg_,
+                float avgDecay) {
+  float* params = params_->data();
+  const float* grads = grads_->data();
+  float* mt = mt_->data();
+  float* vt = vt_->data();
+  float* avg = paramsAvg_ ? paramsAvg_->data() : nullptr;
+  size_t size = params_->size();
+
+  // same operations in the same order as the separate Element() calls on GPU
+#pragma omp parallel for simd
+  for(size_t i = 0; i < size; ++i) {
+    float g = gradScale * grads[i];
+    float m = (beta1 * mt[i]) + ((1 - beta1) * g);
+    float v = (beta2 * vt[i]) + ((1 - beta2) * (g * g));
+    mt[i] = m;
+    vt[i] = v;
+    float p = params[i] - eta * ((m / denom1) / (std::sqrt(v / denom2) + eps) + w * params[i]);
+    params[i] = p;
+    if(avg)
+      avg[i] = ((1.f - avgDecay) * avg[i]) + (avgDecay * p);
+  }
+}
+
+void AdagradUpdate(Tensor params_,
+                   const Tensor grads_,
+                   Tensor gt_,
+                   float eta,
+                   float eps,
+                   float gradScale,
+                   Tensor paramsAvg_,
+                   float avgDecay) {
+  float* params = params_->data();
+  const float* grads = grads_->data();
+  float* gt = gt_->data();
+  float* avg = paramsAvg_ ? paramsAvg_->data() : nullptr;
+  size_t size = params_->size();
+
+#pragma omp parallel for simd
+  for(size_t i = 0; i < size; ++i) {
+    float g = gradScale * grads[i];
+    float sum = gt[i] + (g * g);
+    gt[i] = sum;
+    float p = params[i] - (eta / (std::sqrt(sum) + eps)) * g;
+    params[i] = p;
+    if(avg)
+      avg[i] = ((1.f - avgDecay) * avg[i]) + (avgDecay * p);
+  }
+}
+
 void Att(Tensor out_, Tensor va_, Tensor context_, Tensor state_) {
   float* out = out_->data();
   const float* va = va_->data();
@@ -819,48 +901,228 @@ void AttBack(Tensor gVa_,
   }
 }
 
+// Single-pass mean and variance of the row x (+ residual) with Welford's algorithm. The row is
+// processed as LN_LANES interleaved streams, each with its own running mean and M2, so that the
+// inner loop vectorizes; the lanes are merged at the end with Chan's parallel update.
+#define LN_LANES 8
+
+template <bool hasResidual>
+static inline void welfordMeanVar(const float* x,
+                                  const float* residual,
+                                  int cols,
+                                  float& mean,
+                                  float& var) {
+  float laneMean[LN_LANES] = {0.f};
+  float laneM2[LN_LANES] = {0.f};
+
+  int blocks = cols / LN_LANES;
+  for(int k = 0; k < blocks; ++k) {
+    const float* xb = x + k * LN_LANES;
+    const float* rb = hasResidual ? residual + k * LN_LANES : nullptr;
+    float invCount = 1.f / (k + 1);
+#pragma omp simd
+    for(int l = 0; l < LN_LANES; ++l) {
+      float v = hasResidual ? xb[l] + rb[l] : xb[l];
+      float delta = v - laneMean[l];
+      laneMean[l] += delta * invCount;
+      laneM2[l] += delta * (v - laneMean[l]);
+    }
+  }
+
+  float n = 0.f;
+  float m = 0.f;
+  float m2 = 0.f;
+  if(blocks > 0) {
+    for(int l = 0; l < LN_LANES; ++l) {
+      float nl = (float)blocks;
+      float delta = laneMean[l] - m;
+      float nn = n + nl;
+      m += delta * nl / nn;
+      m2 += laneM2[l] + delta * delta * n * nl / nn;
+      n = nn;
+    }
+  }
+
+  for(int i = blocks * LN_LANES; i < cols; ++i) {
+    float v = hasResidual ? x[i] + residual[i] : x[i];
+    n += 1.f;
+    float delta = v - m;
+    m += delta / n;
+    m2 += delta * (v - m);
+  }
+
+  mean = m;
+  var = m2 / cols;
+}
+
+template <bool hasResidual>
+static void layerNormalizationImpl(float* out,
+                                   const float* in,
+                                   const float* residual,
+                                   const float* alpha,
+                                   const float* beta,
+                                   int rows,
+                                   int cols,
+                                   float eps) {
+#pragma omp parallel for
+  for(int j = 0; j < rows; ++j) {
+    float* so = out + j * cols;
+    const float* sp = in + j * cols;
+    const float* sr = hasResidual ? residual + j * cols : nullptr;
+
+    float mean, var;
+    welfordMeanVar<hasResidual>(sp, sr, cols, mean, var);
+
+    float invSigma = 1.f / std::sqrt(eps + var);
+
+    if(beta != nullptr) {
+#pragma omp simd
+      for(int i = 0; i < cols; ++i) {
+        float v = hasResidual ? sp[i] + sr[i] : sp[i];
+        so[i] = alpha[i] * ((v - mean) * invSigma) + beta[i];
+      }
+    } else {
+#pragma omp simd
+      for(int i = 0; i < cols; ++i) {
+        float v = hasResidual ? sp[i] + sr[i] : sp[i];
+        so[i] = alpha[i] * ((v - mean) * invSigma);
+      }
+    }
+  }
+}
+
 void LayerNormalization(Tensor out_,
                         Tensor in_,
                         Tensor gamma_,
                         Tensor beta_,
                         float eps) {
-  float* out = out_->data();
-  const float* in = in_->data();
-  const float* alpha = gamma_->data();
-  const float* beta = beta_ ? beta_->data() : nullptr;
-
   int rows = in_->shape().elements() / in_->shape().back();
   int cols = in_->shape().back();
 
-#pragma omp parallel for
-  for(int j = 0; j < rows; ++j) {
-    float* so = out + j * cols;
-    const float* sp = in + j * cols;
+  layerNormalizationImpl<false>(out_->data(),
+                                in_->data(),
+                                nullptr,
+                                gamma_->data(),
+                                beta_ ? beta_->data() : nullptr,
+                                rows,
+                                cols,
+                                eps);
+}
 
-    float sum = 0.f;
-#pragma omp simd reduction(+ : sum)
-    for(int i = 0; i < cols; ++i) {
-      sum += sp[i];
-    }
+void LayerNormalizationResidual(Tensor out_,
+                                Tensor in_,
+                                Tensor residual_,
+                                Tensor gamma_,
+                                Tensor beta_,
+                                float eps) {
+  int rows = in_->shape().elements() / in_->shape().back();
+  int cols = in_->shape().back();
 
-    float mean = sum / cols;
-    float sqSum = 0.f;
-#pragma omp simd reduction(+ : sqSum)
-    for(int i = 0; i < cols; ++i) {
-      float ex = sp[i] - mean;
-      sqSum += ex * ex;
-    }
+  layerNormalizationImpl<true>(out_->data(),
+                               in_->data(),
+                               residual_->data(),
+                               gamma_->data(),
+                               beta_ ? beta_->data() : nullptr,
+                               rows,
+                               cols,
+                               eps);
+}
+
+// Gradient of one row of y = gamma * (x + residual - mean) / sigma + beta. The row gradient is
+// added to gradX and gradResidual (either may be null if that input does not require a gradient).
+template <bool hasResidual>
+static inline void layerNormalizationGradRow(float* gradXRow,
+                                             float* gradResidualRow,
+                                             float* gradGamma,
+                                             float* gradBeta,
+                                             const float* adjRow,
+                                             const float* yRow,
+                                             const float* xRow,
+                                             const float* residualRow,
+                                             const float* gamma,
+                                             const float* beta,
+                                             size_t cols,
+                                             float eps) {
+  float sum_adj = 0.f;
+  float sum_adj_x = 0.f;
+
+#pragma omp simd reduction(+ : sum_adj_x, sum_adj)
+  for(size_t i = 0; i < cols; ++i) {
+    sum_adj_x += adjRow[i] * (yRow[i] - (beta ? beta[i] : 0.f)) / gamma[i];
+    sum_adj += adjRow[i];
+  }
 
-    float sigma = std::sqrt(eps + sqSum / cols);
+  float mean, var;
+  welfordMeanVar<hasResidual>(xRow, residualRow, (int)cols, mean, var);
+  float sigma = std::sqrt(eps + var);
 
 #pragma omp simd
-    for(int i = 0; i < cols; ++i) {
-      float t = alpha[i] * ((sp[i] - mean) / sigma);
-      if(beta != nullptr) {
-        t += beta[i];
-      }
+  for(size_t i = 0; i < cols; ++i) {
+    float grad_x = 0.f;
+    float x_hat = (yRow[i] - (beta ? beta[i] : 0.f)) / gamma[i];
+    grad_x += cols * adjRow[i];
+    grad_x -= sum_adj;
+    grad_x -= sum_adj_x * x_hat;
+    grad_x /= cols * sigma;
+
+    float grad = gamma[i] * grad_x;
+    if(gradXRow)
+      gradXRow[i] += grad;
+    if(hasResidual && gradResidualRow)
+      gradResidualRow[i] += grad;
+    gradGamma[i] += adjRow[i] * x_hat;
+    if(gradBeta)
+      gradBeta[i] += adjRow[i];
+  }
+}
 
-      so[i] = t;
+template <bool hasResidual>
+static void layerNormalizationGradImpl(float* gradX,
+                                       float* gradResidual,
+                                       float* gradGamma,
+                                       float* gradBeta,
+                                       const float* adj,
+                                       const float* y,
+                                       const float* x,
+                                       const float* residual,
+                                       const float* gamma,
+                                       const float* beta,
+                                       size_t rows,
+                                       size_t cols,
+                                       float eps) {
+  if(beta) {
+#pragma omp parallel for reduction(+ : gradGamma[:cols], gradBeta[:cols])
+    for(size_t j = 0; j < rows; ++j) {
+      layerNormalizationGradRow<hasResidual>(
+          gradX ? gradX + j * cols : nullptr,
+          gradResidual ? gradResidual + j * cols : nullptr,
+          gradGamma,
+          gradBeta,
+          adj + j * cols,
+          y + j * cols,
+          x + j * cols,
+          hasResidual ? residual + j * cols : nullptr,
+          gamma,
+          beta,
+          cols,
+          eps);
+    }
+  } else {
+#pragma omp parallel for reduction(+ : gradGamma[:cols])
+    for(size_t j = 0; j < rows; ++j) {
+      layerNormalizationGradRow<hasResidual>(
+          gradX ? gradX + j * cols : nullptr,
+          gradResidual ? gradResidual + j * cols : nullptr,
+          gradGamma,
+          nullptr,
+          adj + j * cols,
+          y + j * cols,
+          x + j * cols,
+          hasResidual ? residual + j * cols : nullptr,
+          gamma,
+          nullptr,
+          cols,
+          eps);
     }
   }
 }
@@ -874,102 +1136,51 @@ void LayerNormalizationGrad(Tensor gradX_,
                             Tensor gamma_,
                             Tensor beta_,
                             float eps) {
-  float* gradX = gradX_->data();
-  float* gradGamma = gradGamma_->data();
-  float* gradBeta = gradBeta_ ? gradBeta_->data() : nullptr;
-  float* adj = adj_->data();
-  float* y = y_->data();
-  float* x = x_->data();
-  float* gamma = gamma_->data();
-  float* beta = beta_ ? beta_->data() : nullptr;
-
   size_t rows = y_->shape().elements() / y_->shape()[-1];
   size_t cols = y_->shape()[-1];
 
-  if(beta) {
-#pragma omp parallel for reduction(+ : gradGamma[:cols], gradBeta[:cols])
-    for(size_t j = 0; j < rows; ++j) {
-      const float* xRow = x + j * cols;
-      const float* yRow = y + j * cols;
-      const float* adjRow = adj + j * cols;
-      float* gradXRow = gradX + j * cols;
-
-      float sum_x = 0.f;
-      float sum_adj = 0.f;
-      float sum_adj_x = 0.f;
-      float sum_sqr = 0.f;
-
-#pragma omp simd reduction(+ : sum_x, sum_adj_x, sum_adj)
-      for(size_t i = 0; i < cols; ++i) {
-        sum_x += xRow[i];
-        sum_adj_x += adjRow[i] * (yRow[i] - (beta ? beta[i] : 0.f)) / gamma[i];
-        sum_adj += adjRow[i];
-      }
-
-      float mean = sum_x / cols;
-#pragma omp simd reduction(+ : sum_sqr)
-      for(size_t i = 0; i < cols; ++i) {
-        float ex = xRow[i] - mean;
-        sum_sqr += ex * ex;
-      }
-
-      float sigma = std::sqrt(eps + sum_sqr / cols);
-#pragma omp simd
-      for(size_t i = 0; i < cols; ++i) {
-        float grad_x = 0.f;
-        float x_hat = (yRow[i] - beta[i]) / gamma[i];
-        grad_x += cols * adjRow[i];
-        grad_x -= sum_adj;
-        grad_x -= sum_adj_x * x_hat;
-        grad_x /= cols * sigma;
-
-        gradXRow[i] += gamma[i] * grad_x;
-        gradGamma[i] += adjRow[i] * x_hat;
-        gradBeta[i] += adjRow[i];
-      }
-    }
-  } else {
-#pragma omp parallel for reduction(+ : gradGamma[:cols])
-    for(size_t j = 0; j < rows; ++j) {
-      const float* xRow = x + j * cols;
-      const float* yRow = y + j * cols;
-      const float* adjRow = adj + j * cols;
-      float* gradXRow = gradX + j * cols;
-
-      float sum_x = 0.f;
-      float sum_adj = 0.f;
-      float sum_adj_x = 0.f;
-      float sum_sqr = 0.f;
-
-#pragma omp simd reduction(+ : sum_x, sum_adj_x, sum_adj)
-      for(size_t i = 0; i < cols; ++i) {
-        sum_x += xRow[i];
-        sum_adj_x += adjRow[i] * (yRow[i] - (beta ? beta[i] : 0.f)) / gamma[i];
-        sum_adj += adjRow[i];
-      }
+  layerNormalizationGradImpl<false>(gradX_->data(),
+                                    nullptr,
+                                    gradGamma_->data(),
+                                    gradBeta_ ? gradBeta_->data() : nullptr,
+                                    adj_->data(),
+                                    y_->data(),
+                                    x_->data(),
+                                    nullptr,
+                                    gamma_->data(),
+                                    beta_ ? beta_->data() : nullptr,
+                                    rows,
+                                    cols,
+                                    eps);
+}
 
-      float mean = sum_x / cols;
-#pragma omp simd reduction(+ : sum_sqr)
-      for(size_t i = 0; i < cols; ++i) {
-        float ex = xRow[i] - mean;
-        sum_sqr += ex * ex;
-      }
+void LayerNormalizationResidualGrad(Tensor gradX_,
+                                    Tensor gradResidual_,
+                                    Tensor gradGamma_,
+                                    Tensor gradBeta_,
+                                    Tensor adj_,
+                                    Tensor y_,
+                                    Tensor x_,
+                                    Tensor residual_,
+                                    Tensor gamma_,
+                                    Tensor beta_,
+                                    float eps) {
+  size_t rows = y_->shape().elements() / y_->shape()[-1];
+  size_t cols = y_->shape()[-1];
 
-      float sigma = std::sqrt(eps + sum_sqr / cols);
-#pragma omp simd
-      for(size_t i = 0; i < cols; ++i) {
-        float grad_x = 0.f;
-        float x_hat = yRow[i] / gamma[i];
-        grad_x += cols * adjRow[i];
-        grad_x -= sum_adj;
-        grad_x -= sum_adj_x * x_hat;
-        grad_x /= cols * sigma;
-
-        gradXRow[i] += gamma[i] * grad_x;
-        gradGamma[i] += adjRow[i] * x_hat;
-      }
-    }
-  }
+  layerNormalizationGradImpl<true>(gradX_ ? gradX_->data() : nullptr,
+                                   gradResidual_ ? gradResidual_->data() : nullptr,
+                                   gradGamma_->data(),
+                                   gradBeta_ ? gradBeta_->data() : nullptr,
+                                   adj_->data(),
+                                   y_->data(),
+                                   x_->data(),
+                                   residual_->data(),
+                                   gamma_->data(),
+                                   beta_ ? beta_->data() : nullptr,
+                                   rows,
+                                   cols,
+                                   eps);
 }
 
 void Shift(Tensor out_,
@@ -1438,6 +1438,7 @@ void AttBack(Tensor gVa,
 
 __global__ void gLNormalization(float* out,
                                 const float* in,
+                                const float* residual,
                                 const float* alpha,
                                 const float* beta,
                                 int rows,
@@ -1450,13 +1451,14 @@ __global__ void gLNormalization(float* out,
     if(j < rows) {
       float* so = out + j * cols;
       const float* sp = in + j * cols;
+      const float* sr = residual ? residual + j * cols : nullptr;
 
       float* _sum = _share + blockDim.x;
       _sum[threadIdx.x] = 0.0f;
       for(int tid = 0; tid < cols; tid += blockDim.x) {
         int id = tid + threadIdx.x;
         if(id < cols) {
-          _sum[threadIdx.x] += sp[id];
+          _sum[threadIdx.x] += sr ? sp[id] + sr[id] : sp[id];
         }
       }
       __syncthreads();
@@ -1479,7 +1481,7 @@ __global__ void gLNormalization(float* out,
       for(int tid = 0; tid < cols; tid += blockDim.x) {
         int id = tid + threadIdx.x;
         if(id < cols) {
-          float ex = sp[id] - mean;
+          float ex = (sr ? sp[id] + sr[id] : sp[id]) - mean;
           _sqSum[threadIdx.x] += ex * ex;
         }
       }
@@ -1499,7 +1501,7 @@ __global__ void gLNormalization(float* out,
       for(int tid = 0; tid < cols; tid += blockDim.x) {
         int id = tid + threadIdx.x;
         if(id < cols) {
-          float t = alpha[id] * ((sp[id] - mean) / sigma);
+          float t = alpha[id] * (((sr ? sp[id] + sr[id] : sp[id]) - mean) / sigma);
           if(beta != nullptr)
             t += beta[id];
           so[id] = t;
@@ -1525,6 +1527,32 @@ void LayerNormalization(Tensor out,
 
   gLNormalization<<<blocks, threads, shared>>>(out->data(),
                                                in->data(),
+                                               nullptr,
+                                               gamma->data(),
+                                               beta ? beta->data() : nullptr,
+                                               rows,
+                                               cols,
+                                               eps);
+}
+
+void LayerNormalizationResidual(Tensor out,
+                                Tensor in,
+                                Tensor residual,
+                                Tensor gamma,
+                                Tensor beta,
+                                float eps) {
+  cudaSetDevice(out->getDeviceId().no);
+
+  int rows = in->shape().elements() / in->shape().back();
+  int cols = in->shape().back();
+
+  int blocks = std::min(MAX_BLOCKS, (int)rows);
+  int threads = std::min(MAX_THREADS, (int)cols);
+  int shared = 2 * threads * sizeof(float);
+
+  gLNormalization<<<blocks, threads, shared>>>(out->data(),
+                                               in->data(),
+                                               residual->data(),
                                                gamma->data(),
                                                beta ? beta->data() : nullptr,
                                                rows,
@@ -1533,11 +1561,13 @@ void LayerNormalization(Tensor out,
 }
 
 __global__ void gLayerNormalizationGrad(float* gradX,
+                                        float* gradResidual,
                                         float* gradGamma,
                                         float* gradBeta,
                                         float* adj,
                                         float* y,
                                         float* x,
+                                        float* residual,
                                         float* gamma,
                                         float* beta,
                                         int rows,
@@ -1554,9 +1584,11 @@ __global__ void gLayerNormalizationGrad(float* gradX,
       float* sum_sqr = shared + 3 * blockDim.x;
 
       const float* xRow = x + j * cols;
+      const float* rRow = residual ? residual + j * cols : nullptr;
       const float* yRow = y + j * cols;
       const float* adjRow = adj + j * cols;
-      float* gradXRow = gradX + j * cols;
+      float* gradXRow = gradX ? gradX + j * cols : nullptr;
+      float* gradRRow = gradResidual ? gradResidual + j * cols : nullptr;
 
       sum_x[threadIdx.x] = 0.0f;
       sum_adj[threadIdx.x] = 0.0f;
@@ -1566,7 +1598,7 @@ __global__ void gLayerNormalizationGrad(float* gradX,
       for(int tid = 0; tid < cols; tid += blockDim.x) {
         int id = tid + threadIdx.x;
         if(id < cols) {
-          sum_x[threadIdx.x] += xRow[id];
+          sum_x[threadIdx.x] += rRow ? xRow[id] + rRow[id] : xRow[id];
           sum_adj_x[threadIdx.x]
               += adjRow[id] * (yRow[id] - ((beta) ? beta[id] : 0)) / gamma[id];
           sum_adj[threadIdx.x] += adjRow[id];
@@ -1591,7 +1623,7 @@ __global__ void gLayerNormalizationGrad(float* gradX,
       for(int tid = 0; tid < cols; tid += blockDim.x) {
         int id = tid + threadIdx.x;
         if(id < cols) {
-          float ex = xRow[id] - mean;
+          float ex = (rRow ? xRow[id] + rRow[id] : xRow[id]) - mean;
           sum_sqr[threadIdx.x] += ex * ex;
         }
       }
@@ -1623,7 +1655,10 @@ __global__ void gLayerNormalizationGrad(float* gradX,
           float sign = (0.f < valX) - (valX < 0.f);
           valX = fabs(valX) > 1000 ? sign * 1000 : valX;
 
-          gradXRow[id] += valX;
+          if(gradXRow)
+            gradXRow[id] += valX;
+          if(gradRRow)
+            gradRRow[id] += valX;
           atomicAdd(gradGamma + id, adjRow[id] * x_hat);
           if(beta) {
             atomicAdd(gradBeta + id, adjRow[id]);
@@ -1653,11 +1688,48 @@ void LayerNormalizationGrad(Tensor gradX,
 
   gLayerNormalizationGrad<<<blocks, threads, shared>>>(
       gradX->data(),
+      nullptr,
+      gradGamma->data(),
+      (gradBeta) ? gradBeta->data() : nullptr,
+      adj->data(),
+      y->data(),
+      x->data(),
+      nullptr,
+      gamma->data(),
+      (beta) ? beta->data() : nullptr,
+      rows,
+      cols,
+      eps);
+}
+
+void LayerNormalizationResidualGrad(Tensor gradX,
+                                    Tensor gradResidual,
+                                    Tensor gradGamma,
+                                    Tensor gradBeta,
+                                    Tensor adj,
+                                    Tensor y,
+                                    Tensor x,
+                                    Tensor residual,
+                                    Tensor gamma,
+                                    Tensor beta,
+                                    float eps) {
+  cudaSetDevice(adj->getDeviceId().no);
+  int rows = y->shape().elements() / y->shape()[-1];
+  int cols = y->shape()[-1];
+
+  int threads = std::min(MAX_THREADS, cols);
+  int blocks = std::min(MAX_BLOCKS, rows);
+  int shared = sizeof(float) * threads * 4;
+
+  gLayerNormalizationGrad<<<blocks, threads, shared>>>(
+      (gradX) ? gradX->data() : nullptr,
+      (gradResidual) ? gradResidual->data() : nullptr,
       gradGamma->data(),
       (gradBeta) ? gradBeta->data() : nullptr,
       adj->data(),
       y->data(),
       x->data(),
+      residual->data(),
       gamma->data(),
       (beta) ? beta->data() : nullptr,
       rows,
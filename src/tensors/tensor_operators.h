@@ -137,9 +137,61 @@ static inline void Deconcatenate(std::vector<marian::Tensor>& outputs,
     cpu::Deconcatenate(outputs, in, ax);
 }
 
+// Layer normalization of (x + residual) fused with its backward step. Dispatched on adj, as the
+// gradients of x and residual are null if the respective input does not require a gradient.
+#ifdef CUDA_FOUND
+namespace gpu {
+void LayerNormalizationResidualGrad(marian::Tensor gradX,
+                                    marian::Tensor gradResidual,
+                                    marian::Tensor gradGamma,
+                                    marian::Tensor gradBeta,
+                                    marian::Tensor adj,
+                                    marian::Tensor y,
+                                    marian::Tensor x,
+                                    marian::Tensor residual,
+                                    marian::Tensor gamma,
+                                    marian::Tensor beta,
+                                    float eps);
+}
+#endif
+
+namespace cpu {
+void LayerNormalizationResidualGrad(marian::Tensor gradX,
+                                    marian::Tensor gradResidual,
+                                    marian::Tensor gradGamma,
+                                    marian::Tensor gradBeta,
+                                    marian::Tensor adj,
+                                    marian::Tensor y,
+                                    marian::Tensor x,
+                                    marian::Tensor residual,
+                                    marian::Tensor gamma,
+                                    marian::Tensor beta,
+                                    float eps);
+}
+
+static inline void LayerNormalizationResidualGrad(marian::Tensor gradX,
+                                                  marian::Tensor gradResidual,
+                                                  marian::Tensor gradGamma,
+                                                  marian::Tensor gradBeta,
+                                                  marian::Tensor adj,
+                                                  marian::Tensor y,
+                                                  marian::Tensor x,
+                                                  marian::Tensor residual,
+                                                  marian::Tensor gamma,
+                                                  marian::Tensor beta,
+                                                  float eps) {
+#ifdef CUDA_FOUND
+  if(adj->getBackend()->getDeviceId().type == DeviceType::gpu)
+    gpu::LayerNormalizationResidualGrad(gradX, gradResidual, gradGamma, gradBeta, adj, y, x, residual, gamma, beta, eps);
+  else
+#endif
+    cpu::LayerNormalizationResidualGrad(gradX, gradResidual, gradGamma, gradBeta, adj, y, x, residual, gamma, beta, eps);
+}
+
 // clang-format off
 DISPATCH5(LayerNormalization, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, float)
 DISPATCH9(LayerNormalizationGrad, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, float)
+DISPATCH6(LayerNormalizationResidual, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, float)
 
 DISPATCH4(HighwayForward, marian::Tensor, const marian::Tensor, const marian::Tensor, const marian::Tensor)
 DISPATCH7(HighwayBackward, marian::Tensor, marian::Tensor, marian::Tensor, const marian::Tensor, const marian::Tensor, const marian::Tensor, const marian::Tensor)
@@ -238,6 +290,43 @@ static inline void GRUFastBackward(std::vector<marian::Tensor> outputs,
 }
 
 // clang-format off
+namespace cpu {
+// Fused optimizer steps, see Sgd::updateImpl(), Adam::updateImpl() and Adagrad::updateImpl().
+// They read and write parameters, gradient and optimizer state in a single pass; the gradient is
+// multiplied by gradScale (for clipping) on the fly and left unchanged in memory. If paramsAvg is
+// given, the exponentially smoothed parameters are updated from the new values in the same pass.
+void SgdUpdate(marian::Tensor params,
+               const marian::Tensor grads,
+               float eta,
+               float gradScale,
+               marian::Tensor paramsAvg,
+               float avgDecay);
+
+void AdamUpdate(marian::Tensor params,
+                const marian::Tensor grads,
+                marian::Tensor mt,
+                marian::Tensor vt,
+                float eta,
+                float beta1,
+                float beta2,
+                float denom1,
+                float denom2,
+                float eps,
+                float w,
+                float gradScale,
+                marian::Tensor paramsAvg,
+                float avgDecay);
+
+void AdagradUpdate(marian::Tensor params,
+                   const marian::Tensor grads,
+                   marian::Tensor gt,
+                   float eta,
+                   float eps,
+                   float gradScale,
+                   marian::Tensor paramsAvg,
+                   float avgDecay);
+}
+
 DISPATCH4(Att, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor)
 DISPATCH7(AttBack, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor, marian::Tensor)
 // clang-format on
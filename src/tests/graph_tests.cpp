@@ -105,3 +105,47 @@ TEST_CASE("Expression graph can be initialized with constant values (cpu)",
     REQUIRE(values == v);
   }
 }
+
+TEST_CASE("Activation checkpointing gives the same gradients (cpu)", "[graph]") {
+  std::vector<float> vX = {0.1f, -0.4f, 0.7f, 0.2f, -0.3f, 0.5f, 0.9f, -0.8f};
+  std::vector<float> vW = {0.5f, -0.1f, 0.2f, 0.3f, -0.6f, 0.4f, 0.1f, -0.2f,
+                           0.3f, 0.7f, -0.5f, 0.1f, 0.2f, -0.3f, 0.6f, 0.4f};
+
+  auto run = [&](bool checkpointing, std::vector<float>& grads) {
+    auto graph = New<ExpressionGraph>();
+    graph->setDevice({0, DeviceType::cpu});
+    graph->reserveWorkspaceMB(4);
+
+    auto x = graph->constant({2, 4}, inits::from_vector(vX));
+    auto W = graph->param("W", {4, 4}, inits::from_vector(vW));
+
+    Expr inner;
+    auto h = x;
+    for(int i = 0; i < 3; ++i) {
+      auto a = tanh(dot(h, W));
+      if(i == 1)
+        inner = a;
+      // the checkpoint is a view, its memory belongs to the sum
+      h = reshape(reshape(a + h, {1, 8}), {2, 4});
+      if(checkpointing)
+        h = graph->checkpoint(h);
+    }
+    auto cost = sum(sum(h * h, -1), -2);
+
+    graph->forward();
+    // values inside of a segment are freed after the forward step
+    CHECK((bool)inner->val() == !checkpointing);
+    float value = cost->scalar();
+
+    graph->backward();
+    W->grad()->get(grads);
+    return value;
+  };
+
+  std::vector<float> grads, gradsCheckpointed;
+  float cost = run(false, grads);
+  float costCheckpointed = run(true, gradsCheckpointed);
+
+  CHECK(cost == costCheckpointed);
+  CHECK(grads == gradsCheckpointed);
+}
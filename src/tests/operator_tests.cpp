@@ -1,6 +1,7 @@
 #include "catch.hpp"
 #include "graph/expression_graph.h"
 #include "graph/expression_operators.h"
+#include "tensors/cpu/bf16.h"
 
 using namespace marian;
 
@@ -183,6 +184,60 @@ void tests(DeviceType device) {
 
   }
 
+  SECTION("layer normalization with residual") {
+    graph->clear();
+    values.clear();
+
+    std::vector<float> vX({
+      0.1f, -0.5f, 2.3f, 1.2f, -0.7f, 0.9f, 0.4f, -1.1f, 1.8f,
+      -0.2f, 0.6f, -2.1f, 0.3f, 0.8f, -0.4f, 1.5f, -0.9f, 0.0f
+    });
+    std::vector<float> vR({
+      1.0f, 0.2f, -0.3f, 0.4f, 0.5f, -1.6f, 0.7f, 0.8f, -0.9f,
+      0.3f, -1.2f, 0.1f, 2.4f, -0.5f, 0.6f, -0.7f, 1.3f, 0.2f
+    });
+    std::vector<float> vC({
+      0.5f, -1.f, 2.f, 1.f, -0.5f, 0.25f, 1.5f, -2.f, 0.75f
+    });
+
+    // 9 columns exercise both the vectorized lanes and the tail of the single-pass statistics
+    auto x = graph->param("ln_x", {2, 9}, inits::from_vector(vX));
+    auto r = graph->param("ln_r", {2, 9}, inits::from_vector(vR));
+    auto gamma = graph->param("ln_gamma", {1, 9}, inits::from_value(1.5f));
+    auto beta = graph->param("ln_beta", {1, 9}, inits::from_value(0.5f));
+    auto c = graph->constant({1, 9}, inits::from_vector(vC));
+
+    auto ln = layerNorm(x + r, gamma, beta);
+    auto loss = sum(sum(ln * c, /*axis=*/-1), /*axis=*/0);
+    graph->backprop();
+
+    std::vector<float> yRef, gxRef, grRef, gGammaRef, gBetaRef;
+    ln->val()->get(yRef);
+    x->grad()->get(gxRef);
+    r->grad()->get(grRef);
+    gamma->grad()->get(gGammaRef);
+    beta->grad()->get(gBetaRef);
+
+    graph->clear();
+    c = graph->constant({1, 9}, inits::from_vector(vC));
+    ln = layerNormResidual(x, r, gamma, beta);
+    loss = sum(sum(ln * c, /*axis=*/-1), /*axis=*/0);
+    graph->backprop();
+
+    CHECK(ln->shape() == Shape({2, 9}));
+
+    ln->val()->get(values);
+    CHECK( std::equal(values.begin(), values.end(), yRef.begin(), floatApprox) );
+    x->grad()->get(values);
+    CHECK( std::equal(values.begin(), values.end(), gxRef.begin(), floatApprox) );
+    r->grad()->get(values);
+    CHECK( std::equal(values.begin(), values.end(), grRef.begin(), floatApprox) );
+    gamma->grad()->get(values);
+    CHECK( std::equal(values.begin(), values.end(), gGammaRef.begin(), floatApprox) );
+    beta->grad()->get(values);
+    CHECK( std::equal(values.begin(), values.end(), gBetaRef.begin(), floatApprox) );
+  }
+
   SECTION("reductions") {
     graph->clear();
     values.clear();
@@ -616,4 +671,78 @@ TEST_CASE("Expression graph supports basic math operations (gpu)", "[operator]")
 TEST_CASE("Expression graph supports basic math operations (cpu)", "[operator]") {
   tests(DeviceType::cpu);
 }
+
+TEST_CASE("Products with bfloat16 weights (cpu)", "[operator]") {
+  auto graph = New<ExpressionGraph>(/*inference=*/true);
+  graph->setDevice({0, DeviceType::cpu});
+  graph->reserveWorkspaceMB(16);
+
+  // all values are exactly representable in bfloat16
+  auto bf16Param = [&](const std::string& name, const Shape& shape, const std::vector<float>& v) {
+    io::Item item;
+    item.name = name;
+    item.shape = shape;
+    item.type = Type::bfloat16;
+    item.bytes.resize(v.size() * sizeof(uint16_t));
+    for(size_t i = 0; i < v.size(); ++i)
+      ((uint16_t*)item.bytes.data())[i] = cpu::bf16::fromFloat(v[i]);
+    return graph->param(name, shape, inits::from_item(item), /*fixed=*/true, Type::bfloat16);
+  };
+
+  std::vector<float> vA({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  std::vector<float> vB({1, 2, 3, 4, 5, 6});
+  std::vector<float> vBt({1, 3, 5, 2, 4, 6});
+  std::vector<float> vC({22, 28, 49, 64, 76, 100, 103, 136});
+  std::vector<float> vAff({24, 30, 51, 66, 78, 102, 105, 138});
+
+  auto A = graph->param("A", {4, 3}, inits::from_vector(vA));
+  auto B = bf16Param("B", {3, 2}, vB);
+  auto Bt = bf16Param("Bt", {2, 3}, vBt);
+  auto bias = graph->param("bias", {1, 2}, inits::from_value(2));
+
+  auto C = dot(A, B);
+  auto Ct = dot(A, Bt, false, true);
+  auto aff = affine(A, B, bias);
+
+  // more than one panel of 256 columns, compared to the float32 product
+  int m = 3, k = 8, n = 300;
+  std::vector<float> vLA(m * k), vLB(k * n), vLBt(n * k);
+  for(int i = 0; i < m * k; ++i)
+    vLA[i] = (float)(i % 7) - 3;
+  for(int r = 0; r < k; ++r) {
+    for(int j = 0; j < n; ++j) {
+      vLB[r * n + j] = (float)((r + 3 * j) % 11) - 5;
+      vLBt[j * k + r] = vLB[r * n + j];
+    }
+  }
+  auto LA = graph->param("LA", {m, k}, inits::from_vector(vLA));
+  auto LB = graph->param("LB", {k, n}, inits::from_vector(vLB));
+  auto LC = dot(LA, bf16Param("LB16", {k, n}, vLB));
+  auto LCt = dot(LA, bf16Param("LBt16", {n, k}, vLBt), false, true);
+  auto LCRef = dot(LA, LB);
+  graph->forward();
+
+  std::vector<float> values;
+  CHECK(C->shape() == Shape({4, 2}));
+  C->val()->get(values);
+  CHECK(values == vC);
+
+  CHECK(Ct->shape() == Shape({4, 2}));
+  Ct->val()->get(values);
+  CHECK(values == vC);
+
+  aff->val()->get(values);
+  CHECK(values == vAff);
+
+  std::vector<float> valuesRef;
+  LCRef->val()->get(valuesRef);
+  CHECK(LC->shape() == Shape({m, n}));
+  LC->val()->get(values);
+  CHECK(values == valuesRef);
+  LCt->val()->get(values);
+  CHECK(values == valuesRef);
+
+  CHECK(cpu::bf16::toFloat(cpu::bf16::fromFloat(1.f + 1.f / 512)) == 1.f); // rounds to even
+  CHECK(cpu::bf16::toFloat(cpu::bf16::fromFloat(-3.f)) == -3.f);
+}
 #endif
@@ -0,0 +1,184 @@
+#include "catch.hpp"
+#include "functional/functional.h"
+#include "optimizers/optimizers.h"
+#include "tensors/tensor_allocator.h"
+#include "tensors/tensor_operators.h"
+#include "training/exponential_smoothing.h"
+
+using namespace marian;
+
+// odd size, so that the remainder of vectorized loops is covered
+static const int SIZE = 1003;
+static const int STEPS = 4;
+
+static std::vector<float> initialValues() {
+  std::vector<float> values(SIZE);
+  for(int i = 0; i < SIZE; ++i)
+    values[i] = std::cos(0.11f * i);
+  return values;
+}
+
+// different in every step, with a norm well above 1 for clipping
+static std::vector<float> gradientValues(int step) {
+  std::vector<float> values(SIZE);
+  for(int i = 0; i < SIZE; ++i)
+    values[i] = std::sin(0.37f * i + step) * (1 + i % 5);
+  return values;
+}
+
+// optimizer steps as separate Element() calls, like on GPU
+class ElementOptimizer {
+public:
+  ElementOptimizer(const std::string& algorithm,
+                   float eta,
+                   Ptr<ClipperBase> clipper,
+                   Ptr<TensorAllocator> alloc)
+      : algorithm_(algorithm), eta_(eta), clipper_(clipper) {
+    alloc->allocate(mt_, {1, SIZE});
+    alloc->allocate(vt_, {1, SIZE});
+    mt_->set(0.f);
+    vt_->set(0.f);
+  }
+
+  void update(Tensor params, Tensor grads) {
+    using namespace functional;
+    if(clipper_)
+      clipper_->clip(grads);
+
+    if(algorithm_ == "sgd") {
+      Element(_1 -= eta_ * _2, params, grads);
+    } else if(algorithm_ == "adagrad") {
+      Element(_1 += (_2 * _2), mt_, grads);
+      Element(_1 -= (eta_ / (sqrt(_2) + eps_)) * _3, params, mt_, grads);
+    } else {
+      t_++;
+      float denom1 = 1 - (float)std::pow(beta1_, t_);
+      float denom2 = 1 - (float)std::pow(beta2_, t_);
+      Element(_1 = (beta1_ * _1) + ((1 - beta1_) * _2), mt_, grads);
+      Element(_1 = (beta2_ * _1) + ((1 - beta2_) * (_2 * _2)), vt_, grads);
+      Element(_1 -= eta_ * ((_2 / denom1) / (sqrt(_3 / denom2) + eps_)), params, mt_, vt_);
+    }
+  }
+
+private:
+  std::string algorithm_;
+  float eta_;
+  Ptr<ClipperBase> clipper_;
+
+  float beta1_ = 0.9f;
+  float beta2_ = 0.999f;
+  float eps_ = 1e-8f;
+  size_t t_ = 0;
+  Tensor mt_; // first moment for Adam, sum of squares for Adagrad
+  Tensor vt_;
+};
+
+static Ptr<OptimizerBase> fusedOptimizer(const std::string& algorithm,
+                                         float eta,
+                                         Ptr<ClipperBase> clipper) {
+  if(algorithm == "sgd")
+    return Optimizer<Sgd>(eta, clipper);
+  else if(algorithm == "adagrad")
+    return Optimizer<Adagrad>(eta, clipper);
+  else
+    return Optimizer<Adam>(eta, clipper);
+}
+
+TEST_CASE("Fused optimizer steps match separate element-wise steps (cpu)", "[optimizer]") {
+  auto floatApprox = [](float x, float y) { return x == Approx(y); };
+
+  auto backend = BackendByDeviceId({0, DeviceType::cpu}, 1234);
+  auto alloc = New<TensorAllocator>(backend);
+  alloc->reserveExact(64 * SIZE * sizeof(float));
+
+  Tensor params, grads, paramsRef, gradsRef;
+  alloc->allocate(params, {1, SIZE});
+  alloc->allocate(grads, {1, SIZE});
+  alloc->allocate(paramsRef, {1, SIZE});
+  alloc->allocate(gradsRef, {1, SIZE});
+
+  for(std::string algorithm : {"sgd", "adagrad", "adam"}) {
+    for(bool clipping : {false, true}) {
+      INFO(algorithm << (clipping ? " with" : " without") << " clipping");
+      auto clipper = clipping ? New<Norm>(1.f) : nullptr;
+
+      auto opt = fusedOptimizer(algorithm, 0.01f, clipper);
+      ElementOptimizer ref(algorithm, 0.01f, clipper, alloc);
+
+      params->set(initialValues());
+      paramsRef->set(initialValues());
+      for(int step = 0; step < STEPS; ++step) {
+        grads->set(gradientValues(step));
+        gradsRef->set(gradientValues(step));
+        opt->update(params, grads);
+        ref.update(paramsRef, gradsRef);
+      }
+
+      std::vector<float> values, valuesRef, gradValues;
+      params->get(values);
+      paramsRef->get(valuesRef);
+      CHECK(values != initialValues());
+      CHECK(std::equal(values.begin(), values.end(), valuesRef.begin(), floatApprox));
+
+      // the fused step applies clipping on the fly and leaves the gradient as it is
+      grads->get(gradValues);
+      CHECK(gradValues == gradientValues(STEPS - 1));
+    }
+  }
+}
+
+// exposes the update of graph groups with exponential smoothing
+class Smoothing : public ExponentialSmoothing {
+public:
+  Smoothing(float decay, bool fused) : ExponentialSmoothing(decay, fused) {}
+
+  void update(Ptr<OptimizerBase> opt, Tensor params, Tensor grads, Tensor paramsAvg, size_t batches) {
+    updateParams(opt, params, grads, paramsAvg, batches);
+  }
+};
+
+TEST_CASE("Fused exponential smoothing matches the separate update (cpu)", "[optimizer]") {
+  auto floatApprox = [](float x, float y) { return x == Approx(y); };
+
+  auto backend = BackendByDeviceId({0, DeviceType::cpu}, 1234);
+  auto alloc = New<TensorAllocator>(backend);
+  alloc->reserveExact(16 * SIZE * sizeof(float));
+
+  Tensor params, paramsAvg, paramsRef, paramsAvgRef, grads;
+  alloc->allocate(params, {1, SIZE});
+  alloc->allocate(paramsAvg, {1, SIZE});
+  alloc->allocate(paramsRef, {1, SIZE});
+  alloc->allocate(paramsAvgRef, {1, SIZE});
+  alloc->allocate(grads, {1, SIZE});
+
+  for(std::string algorithm : {"sgd", "adagrad", "adam"}) {
+    for(bool clipping : {false, true}) {
+      INFO(algorithm << (clipping ? " with" : " without") << " clipping");
+      auto clipper = clipping ? New<Norm>(1.f) : nullptr;
+
+      auto opt = fusedOptimizer(algorithm, 0.01f, clipper);
+      auto optRef = fusedOptimizer(algorithm, 0.01f, clipper);
+      Smoothing fused(1e-4f, /*fused=*/true), separate(1e-4f, /*fused=*/false);
+
+      params->set(initialValues());
+      paramsAvg->set(initialValues());
+      paramsRef->set(initialValues());
+      paramsAvgRef->set(initialValues());
+      for(int step = 0; step < STEPS; ++step) {
+        grads->set(gradientValues(step));
+        fused.update(opt, params, grads, paramsAvg, step);
+        separate.update(optRef, paramsRef, grads, paramsAvgRef, step);
+      }
+
+      std::vector<float> values, valuesRef;
+      params->get(values);
+      paramsRef->get(valuesRef);
+      CHECK(std::equal(values.begin(), values.end(), valuesRef.begin(), floatApprox));
+
+      paramsAvg->get(values);
+      paramsAvgRef->get(valuesRef);
+      CHECK(values != initialValues());
+      CHECK(std::equal(values.begin(), values.end(), valuesRef.begin(), floatApprox));
+    }
+  }
+}
@@ -5,6 +5,11 @@
 #include "functional/functional.h"
 #include "tensors/tensor_operators.h"
 #include "optimizers/optimizers.h"
+#include "3rd_party/threadpool.h"
+
+#include <future>
+#include <map>
+#include <mutex>
 #if MPI_FOUND
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -40,6 +45,18 @@ public:
   virtual void scatterReduce() const = 0; // reduce param gradients and scatter into gradient shards
   virtual void allGather() const = 0;     // redistribute value shards into param values
 
+  // Alternative to scatterReduce() that overlaps the reduction with backward(). Each local graph
+  // reports ranges of final gradients via gradientsReady() (see
+  // ExpressionGraph::setGradientsReadyCallback()), ranges that all graphs have reported are
+  // reduced right away, and finishScatterReduce() waits until the reduction is complete.
+  virtual bool canOverlapScatterReduce() const { return false; }
+  virtual void gradientsReady(size_t /*localDeviceIndex*/, size_t /*begin*/, size_t /*end*/) const {
+    ABORT("Overlapping scatterReduce() with backward() is not supported by this communicator");
+  }
+  virtual void finishScatterReduce() const {
+    ABORT("Overlapping scatterReduce() with backward() is not supported by this communicator");
+  }
+
   virtual void swapParams(const std::vector<Tensor>& paramShards) const = 0;
 
   virtual void scatterState(const std::vector<float>& data, const OptimizerBase::ScatterStateSetFunc& setFn) const = 0;
@@ -93,7 +110,15 @@ void finalizeMPI(Ptr<IMPIWrapper>&&);
 class DefaultCommunicator : public ICommunicator {
 private:
   std::vector<Ptr<TensorAllocator>> paramsAllocs_;
-  std::vector<Tensor> tmpTensors_;
+  std::vector<Tensor> tmpTensors_; // [deviceIndex] staging buffers for gradients from other devices (not used on CPU)
+
+  static const size_t CPU_CHUNK_SIZE = 64 * 1024; // floats, i.e. 256 KB
+
+  // state of an overlapped scatterReduce(), see gradientsReady()
+  mutable std::mutex bucketMutex_;
+  mutable std::map<size_t, size_t> bucketReports_; // [bucket begin] number of graphs that have reported it
+  mutable std::vector<std::future<void>> bucketReductions_;
+  UPtr<ThreadPool> reducePool_;
 
   void lazyInit() {
     if(tmpTensors_.size() == 0) {
@@ -125,6 +150,8 @@ public:
   DefaultCommunicator(const std::vector<Ptr<ExpressionGraph>>& graphs, Ptr<IMPIWrapper> mpi)
       : ICommunicator(graphs) {
     ABORT_IF(mpi && mpi->numMPIProcesses() != 1, "DefaultCommunicator does not support multi-process MPI");
+    if(canOverlapScatterReduce())
+      reducePool_.reset(new ThreadPool(graphs_.size()));
   }
 
   ~DefaultCommunicator() override {}
@@ -153,48 +180,100 @@ public:
       t.join();
   }
 
+  // Graphs other than idx in ring order, starting from idx's successor. Shard owners working in
+  // parallel then each access a different graph at any time instead of all reading from or
+  // writing to graphs_[0] first, then graphs_[1], and so on.
+  std::vector<Ptr<ExpressionGraph>> ringFrom(size_t idx) const {
+    std::vector<Ptr<ExpressionGraph>> ring;
+    for(size_t k = 1; k < graphs_.size(); ++k)
+      ring.push_back(graphs_[(idx + k) % graphs_.size()]);
+    return ring;
+  }
+
+  bool onCPU() const { return graphs_[0]->getBackend()->getDeviceId().type == DeviceType::cpu; }
+
+  // CPU graphs share memory, so other graphs' gradients can be added directly without staging
+  // them in tmpTensors_. The range is reduced in cache-sized chunks, each of which stays in
+  // cache while the gradients of all graphs are added to it.
+  void reduceCPU(size_t idx, size_t begin, size_t end) const {
+    auto ring = ringFrom(idx);
+    for(size_t pos = begin; pos < end; pos += CPU_CHUNK_SIZE) {
+      size_t size = std::min(end - pos, (size_t)CPU_CHUNK_SIZE);
+      auto curGrad = graphs_[idx]->params()->grads()->subtensor(pos, size);
+      for(auto graph : ring) {
+        using namespace functional;
+        Element(_1 = _1 + _2, curGrad, graph->params()->grads()->subtensor(pos, size));
+      }
+    }
+  }
+
   void scatterReduce() const override {
-    const_cast<DefaultCommunicator*>(this)->lazyInit();
+    if(onCPU()) {
+      foreach([this](size_t idx, size_t begin, size_t end) { reduceCPU(idx, begin, end); });
+      return;
+    }
 
-    int totalSize = (int)graphs_[0]->params()->vals()->size();
-    int shardSize = (int)ceil(totalSize / (float)graphs_.size());
+    const_cast<DefaultCommunicator*>(this)->lazyInit();
 
     // Gather gradients from different devices into current gradient shards
-    auto scatter = [this, shardSize](size_t idx, size_t begin, size_t end) {
+    auto scatter = [this](size_t idx, size_t begin, size_t end) {
       auto curGrad = graphs_[idx]->params()->grads()->subtensor(begin, end-begin);
 
       // collect and sum gradients
-      for(auto graph : graphs_) {
-        if(graph != graphs_[idx]) {
-          auto subGrad = graph->params()->grads()->subtensor(begin, end - begin);
-          tmpTensors_[idx]->copyFrom(subGrad);
+      for(auto graph : ringFrom(idx)) {
+        auto subGrad = graph->params()->grads()->subtensor(begin, end - begin);
+        tmpTensors_[idx]->copyFrom(subGrad);
 
-          using namespace functional;
-          Element(_1 = _1 + _2, curGrad, tmpTensors_[idx]);
-        }
+        using namespace functional;
+        Element(_1 = _1 + _2, curGrad, tmpTensors_[idx]);
       }
     };
 
     foreach(scatter);
   }
 
-  void allGather() const override {
-    int totalSize = (int)graphs_[0]->params()->vals()->size();
-    int shardSize = (int)ceil(totalSize / (float)graphs_.size());
+  // Only on CPU, where ranges can be reduced from other threads without synchronizing with
+  // the devices' streams.
+  bool canOverlapScatterReduce() const override { return onCPU() && graphs_.size() > 1; }
+
+  void gradientsReady(size_t /*localDeviceIndex*/, size_t begin, size_t end) const override {
+    std::lock_guard<std::mutex> lock(bucketMutex_);
+    if(++bucketReports_[begin] < graphs_.size())
+      return;
+    bucketReports_.erase(begin);
+
+    // all graphs are done with [begin, end), reduce its intersection with each shard
+    bucketReductions_.emplace_back(reducePool_->enqueue([this, begin, end]() {
+      foreach([this, begin, end](size_t idx, size_t shardBegin, size_t shardEnd) {
+        if(std::max(begin, shardBegin) < std::min(end, shardEnd))
+          reduceCPU(idx, std::max(begin, shardBegin), std::min(end, shardEnd));
+      }, /*parallel=*/false);
+    }));
+  }
 
+  void finishScatterReduce() const override {
+    std::vector<std::future<void>> reductions;
+    {
+      std::lock_guard<std::mutex> lock(bucketMutex_);
+      ABORT_IF(!bucketReports_.empty(), "Gradients of {} bucket(s) have not been reported by all graphs", bucketReports_.size());
+      reductions.swap(bucketReductions_);
+    }
+    for(auto& reduction : reductions)
+      reduction.get();
+  }
+
+  void allGather() const override {
     // Update all graphs with parameter shard
-    auto gather = [this, shardSize](size_t idx, size_t begin, size_t end) {
+    auto gather = [this](size_t idx, size_t begin, size_t end) {
       auto getShard = [&](Ptr<ExpressionGraph> graph) {
         return graph->params()->vals()->subtensor(begin, end-begin);
       };
       auto curShard = getShard(graphs_[idx]);
 
       // Copy parameter shard to each graph
-      for(auto graph : graphs_) {
-        if(graph != graphs_[idx]) {
-          auto subShard = getShard(graph);
-          subShard->copyFrom(curShard);
-        }
+      for(auto graph : ringFrom(idx)) {
+        auto subShard = getShard(graph);
+        subShard->copyFrom(curShard);
       }
     };
 
@@ -2,6 +2,7 @@
 
 #include "common/definitions.h"
 #include "functional/functional.h"
+#include "optimizers/optimizers.h"
 #include "tensors/tensor_operators.h"
 
 namespace marian {
@@ -12,18 +13,39 @@ namespace marian {
  */
 class ExponentialSmoothing {
 public:
-  ExponentialSmoothing(float decay = 0.0f)
-      : mvAvg_{decay > 0}, mvDecay_{decay} {}
+  ExponentialSmoothing(float decay = 0.0f, bool fused = false)
+      : mvAvg_{decay > 0}, mvDecay_{decay}, mvFused_{fused} {}
 
 protected:
+  float avgDecay(size_t batches) {
+    return std::max(mvDecay_, 1.f - (float)(batches + 1) / (float)(batches + 10));
+  }
+
   void updateAvgParams(Tensor paramsAvg, Tensor params, size_t batches) {
     using namespace functional;
-    float decay = std::max(mvDecay_,
-                           1.f - (float)(batches + 1) / (float)(batches + 10));
+    float decay = avgDecay(batches);
     Element(_1 = ((1.f - decay) * _1) + (decay * _2), paramsAvg, params);
   }
 
+  // Optimizer step on params followed by the update of the smoothed parameters paramsAvg, if
+  // smoothing is enabled. If fused, the optimizer does both in one pass over memory.
+  void updateParams(Ptr<OptimizerBase> opt,
+                    Tensor params,
+                    Tensor grads,
+                    Tensor paramsAvg,
+                    size_t batches) {
+    if(!mvAvg_) {
+      opt->update(params, grads);
+    } else if(mvFused_) {
+      opt->update(params, grads, paramsAvg, avgDecay(batches));
+    } else {
+      opt->update(params, grads);
+      updateAvgParams(paramsAvg, params, batches);
+    }
+  }
+
   bool mvAvg_{false};
   float mvDecay_{1e-4f};
+  bool mvFused_{false};
 };
 }  // namespace marian
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+
+#include "training/gradient_dropping/dropper.h"
+#include "training/gradient_dropping/sparse_tensor.h"
+
+namespace marian {
+
+namespace cpu {
+
+float GradientDropBase::find_threshold(Tensor grads, float rate) {
+  int size = (int)grads->size();
+  int sortSize = std::min(100000, size);
+  int scale = size / sortSize;
+
+  if(!tmp) {
+    tmp = newTensor(sortSize, grads->getBackend());
+  }
+
+  // sample every scale-th magnitude and select the rate-quantile without
+  // fully sorting the sample
+  const float* g = grads->data();
+  float* sample = tmp->data();
+  for(int i = 0; i < sortSize; ++i)
+    sample[i] = std::abs(g[i * scale]);
+
+  int cut_index = std::max(0, (int)(sortSize * rate) - 1);
+  std::nth_element(sample, sample + cut_index, sample + sortSize);
+  return sample[cut_index];
+}
+
+void GradientDropBase::dropGraph(Tensor grads,
+                                 SparseTensor destination,
+                                 float rate,
+                                 float /*momentum*/) {
+  // init
+  if(!residual) {
+    residual = newTensor((int)grads->size(), grads->getBackend());
+    residual->set(0);
+    step = 0;
+  }
+
+  float* g = grads->data();
+  float* r = residual->data();
+  int size = (int)grads->size();
+
+  // Step 1: add residual to the current gradient
+  for(int i = 0; i < size; ++i)
+    g[i] += r[i];
+
+  // Step 2: find threshold
+  float t = find_threshold(grads, rate);
+
+  // Step 3: move gradients above the threshold into the sparse destination and
+  //         keep the rest in the residual. The threshold is only estimated
+  //         from a sample, so gradients that do not fit into the destination
+  //         any more stay in the residual as well and are sent later.
+  float* data = destination->data();
+  int* indices = destination->indices();
+  int capacity = destination->capacity();
+  int n = 0;
+  for(int i = 0; i < size; ++i) {
+    if(std::abs(g[i]) > t && n < capacity) {
+      data[n] = g[i];
+      indices[n] = i;
+      n++;
+      r[i] = 0;
+    } else {
+      r[i] = g[i];
+      g[i] = 0;
+    }
+  }
+  destination->setSize(n);
+
+  step++;
+}
+
+}  // namespace cpu
+}  // namespace marian
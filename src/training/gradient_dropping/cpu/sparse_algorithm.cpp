@@ -0,0 +1,47 @@
+#include "training/gradient_dropping/cpu/sparse_algorithm.h"
+
+#include <algorithm>
+
+namespace marian {
+namespace cpu {
+
+std::vector<int> lower_bounds(int* data, std::vector<int> values, int size) {
+  std::vector<int> output(values.size());
+  for(size_t i = 0; i < values.size(); ++i)
+    output[i] = (int)(std::lower_bound(data, data + size, values[i]) - data);
+  return output;
+}
+
+int buildSparse(Tensor t, float* data, int* indices, int capacity) {
+  const float* in = t->data();
+  int size = (int)t->size();
+  int n = 0;
+  for(int i = 0; i < size && n < capacity; ++i) {
+    if(in[i] != 0.f) {
+      data[n] = in[i];
+      indices[n] = i;
+      n++;
+    }
+  }
+  return n;
+}
+
+void scatterAdd(Tensor t, float* data, int* indices, int size, int offset) {
+  float* out = t->data();
+  for(int i = 0; i < size; ++i)
+    out[indices[i] + offset] += data[i];
+}
+
+void scatterUpdate(Tensor t, float* data, int* indices, int size, int offset) {
+  float* out = t->data();
+  for(int i = 0; i < size; ++i)
+    out[indices[i] + offset] = data[i];
+}
+
+void gather(Tensor t, float* data, int* indices, int size, int offset) {
+  const float* in = t->data();
+  for(int i = 0; i < size; ++i)
+    data[i] = in[indices[i] + offset];
+}
+}  // namespace cpu
+}  // namespace marian
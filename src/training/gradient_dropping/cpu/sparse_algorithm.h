@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common/definitions.h"
+#include "tensors/backend.h"
+#include "tensors/tensor.h"
+
+namespace marian {
+namespace cpu {
+/**
+ * @brief Output[i] is lower_bound of values[i] in data.
+ *
+ * @return A vector of size values.size
+ */
+std::vector<int> lower_bounds(int* data, std::vector<int> values, int size);
+
+/**
+ * @brief Stores the non-zero elements of t and their positions in data and
+ * indices, keeping at most capacity of them.
+ *
+ * @return The number of stored elements
+ */
+int buildSparse(Tensor t, float* data, int* indices, int capacity);
+
+void scatterAdd(Tensor t, float* data, int* indices, int size, int offset);
+
+void scatterUpdate(Tensor t, float* data, int* indices, int size, int offset);
+
+void gather(Tensor t, float* data, int* indices, int size, int offset);
+}  // namespace cpu
+}  // namespace marian
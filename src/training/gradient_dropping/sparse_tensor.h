@@ -7,6 +7,7 @@
 #include "tensors/backend.h"
 #include "tensors/device.h"
 #include "tensors/tensor_operators.h"
+#include "training/gradient_dropping/cpu/sparse_algorithm.h"
 
 #ifdef CUDA_FOUND
 #include "tensors/gpu/algorithm.h"
@@ -95,15 +96,14 @@ public:
   void copyFrom(float* ndata, int* nindices, int nsize) {
     size_ = nsize;
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      std::copy(ndata, ndata + nsize, data());
+      std::copy(nindices, nindices + nsize, indices());
     }
 #ifdef CUDA_FOUND
     else {
       gpu::copy(backend_, ndata, ndata + nsize, data());
       gpu::copy(backend_, nindices, nindices + nsize, indices());
     }
-#else
-    ndata; nindices; // (unused)
 #endif
   }
 
@@ -120,7 +120,7 @@ public:
   // Convert a tensor into a sparse tensor format
   void fromDense(Tensor t) {
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      setSize(cpu::buildSparse(t, data(), indices(), capacity()));
     }
 #ifdef CUDA_FOUND
     else {
@@ -133,42 +133,36 @@ public:
   // Add t[indices[i]] += data[i]
   void scatterAdd(Tensor t, int offset = 0) {
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      cpu::scatterAdd(t, data(), indices(), size(), offset);
     }
 #ifdef CUDA_FOUND
     else {
       gpu::scatterAdd(t, data(), indices(), size(), offset);
     }
-#else
-    t; offset; // (unused)
 #endif
   }
 
   // Add t[indices[i]] = data[i]
   void scatterUpdate(Tensor t, int offset = 0) {
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      cpu::scatterUpdate(t, data(), indices(), size(), offset);
     }
 #ifdef CUDA_FOUND
     else {
       gpu::scatterUpdate(t, data(), indices(), size(), offset);
     }
-#else
-    t; offset; // (unused)
 #endif
   }
 
   // data[i] = t[indices[i]]
   void gather(Tensor t, int offset = 0) {
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      cpu::gather(t, data(), indices(), size(), offset);
     }
 #ifdef CUDA_FOUND
     else {
       gpu::gather(t, data(), indices(), size(), offset);
     }
-#else
-    t; offset; // (unused)
 #endif
   }
 
@@ -181,7 +175,10 @@ public:
     values[1] = pos + subsize - 1;
 
     if(backend_->getDeviceId().type == DeviceType::cpu) {
-      ABORT("Gradient Dropping for CPU is not yet supported");
+      std::vector<int> outputs = cpu::lower_bounds(indices(), values, size());
+
+      startOffset = outputs[0];
+      endOffset = outputs[1];
     }
 #ifdef CUDA_FOUND
     else {
@@ -2,6 +2,7 @@
 
 #include "common/definitions.h"
 #include "common/options.h"
+#include "common/version.h"
 #include "data/batch_generator.h"
 #include "graph/expression_graph.h"
 #include "models/model_base.h"
@@ -22,6 +23,9 @@ protected:
   Ptr<Scheduler> scheduler_; // scheduler that keeps track of how much has been processed
   bool finalized_{false};    // 'true' if training has completed (further updates are no longer allowed)
 
+  // false for all but one process in multi-node training, which must not write shared files
+  virtual bool isMainProcess() const { return true; }
+
 public:
   GraphGroup(Ptr<Options> options) : options_(options), opt_(Optimizer(options)) {}
 
@@ -51,6 +55,64 @@ public:
   virtual Ptr<data::BatchStats> collectStats(Ptr<ExpressionGraph> graph,
                                              Ptr<models::ModelBase> model,
                                              size_t multiplier = 1) {
+    // with --mini-batch-fit-cache, reuse statistics saved next to the model by an earlier run
+    // with the same memory-relevant configuration
+    std::string cachePath, cacheKey;
+    if(options_->get<bool>("mini-batch-fit-cache", false)) {
+      cachePath = options_->get<std::string>("model") + ".batch-stats.yml";
+      cacheKey = statsCacheKey(graph, multiplier);
+      auto stats = data::BatchStats::load(cachePath, cacheKey);
+      if(stats) {
+        LOG(info, "[batching] Loaded statistics for batch fitting from {}", cachePath);
+        return stats;
+      }
+    }
+
+    auto stats = searchStats(graph, model, multiplier);
+
+    if(!cachePath.empty() && isMainProcess()) {
+      stats->save(cachePath, cacheKey);
+      LOG(info, "[batching] Saved statistics for batch fitting to {}", cachePath);
+    }
+    return stats;
+  }
+
+protected:
+  // Hash of everything that determines the workspace use of the fake batches in collectStats():
+  // model shape, sentence lengths, workspace size, batch fitting options, devices and build.
+  std::string statsCacheKey(Ptr<ExpressionGraph> graph, size_t multiplier) {
+    static const std::vector<std::string> prefixes
+        = {"dim-", "enc-", "dec-", "transformer-", "tied-embeddings", "mini-batch-fit"};
+    static const std::set<std::string> keys = {"type", "skip", "layer-normalization",
+        "right-left", "max-length", "workspace", "train-sets", "guided-alignment",
+        "data-weighting-type", "cost-type"};
+
+    // read-only access, which keeps options caches valid
+    const Options& options = *options_;
+    std::map<std::string, std::string> selected;
+    for(const auto& it : options.getYaml()) {
+      auto key = it.first.as<std::string>();
+      bool use = keys.count(key) > 0;
+      for(const auto& prefix : prefixes)
+        use = use || key.compare(0, prefix.size(), prefix) == 0;
+      if(key == "train-sets") // only the number of streams matters
+        selected[key] = std::to_string(it.second.size());
+      else if(use)
+        selected[key] = YAML::Dump(it.second);
+    }
+
+    std::stringstream ss;
+    for(const auto& kv : selected)
+      ss << kv.first << ": " << kv.second << "\n";
+    ss << "device: " << (graph->getDeviceId().type == DeviceType::gpu ? "gpu" : "cpu") << "\n";
+    ss << "multiplier: " << multiplier << "\n";
+    ss << "version: " << buildVersion() << "\n";
+    return std::to_string(std::hash<std::string>()(ss.str()));
+  }
+
+  Ptr<data::BatchStats> searchStats(Ptr<ExpressionGraph> graph,
+                                    Ptr<models::ModelBase> model,
+                                    size_t multiplier) {
     auto stats = New<data::BatchStats>();
 
     size_t numFiles
@@ -66,8 +128,7 @@ public:
     maxLength = (size_t)(std::ceil(maxLength / (float)step) * step);
 
     // @TODO: ugly
-    auto toptions = New<Options>();
-    toptions->merge(options_);
+    auto toptions = New<Options>(*options_);
 
     size_t maxBatch = 512;
     bool fits = true;
@@ -80,29 +141,78 @@ public:
         maxBatch *= 2;
     }
 
-    for(size_t i = step; i <= maxLength; i += step) {
+    // checks if a batch of the given size and sentence length fits, and if so records it
+    auto probe = [&](size_t length, size_t batchSize) {
+      std::vector<size_t> lengths(numFiles, length);
+      auto batch = data::CorpusBatch::fakeBatch(lengths, batchSize, toptions);
+      auto cost = model->build(graph, batch);
+      bool fits = graph->fits();
+      if(fits)
+        stats->add(batch, multiplier);
+      return fits;
+    };
+
+    // binary search for the largest batch size up to maxBatch that fits
+    auto search = [&](size_t length, size_t maxBatch) {
       size_t start = 1;
       size_t end = maxBatch;
-
-      std::vector<size_t> lengths(numFiles, i);
-      fits = true;
-
       do {
         size_t current = (start + end) / 2;
-        auto batch = data::CorpusBatch::fakeBatch(lengths, current, toptions);
-        auto cost = model->build(graph, batch);
-        fits = graph->fits();
-
-        if(fits) {
-          stats->add(batch, multiplier);
+        if(probe(length, current))
           start = current + 1;
-        } else {
+        else
           end = current - 1;
-        }
-      } while(end - start > step);
+      } while(start <= end && end - start > step); // start > end would wrap around
+      return start;
+    };
 
-      maxBatch = start;
+    std::vector<size_t> steps;
+    for(size_t i = step; i <= maxLength; i += step)
+      steps.push_back(i);
+
+    if(!options_->get<bool>("mini-batch-fit-extrapolate", false) || steps.size() <= 3) {
+      for(auto length : steps)
+        maxBatch = search(length, maxBatch);
+      return stats;
     }
+
+    // Memory grows with batch size times a polynomial in the sentence length, linear for
+    // embeddings and feed-forward layers plus a quadratic attention term. Hence the inverse
+    // of the largest batch size is quadratic in the length. Fit it through exact searches
+    // at the shortest, middle and longest length and only verify the prediction for the
+    // other lengths, falling back to a search if the predicted batch does not fit.
+    size_t x0 = steps.front(), x1 = steps[steps.size() / 2], x2 = steps.back();
+    size_t b0 = search(x0, maxBatch);
+    size_t b1 = search(x1, b0);
+    size_t b2 = search(x2, b1);
+    auto inverseBatch = [&](double x) {
+      return (1.0 / b0) * (x - x1) * (x - x2) / (((double)x0 - x1) * ((double)x0 - x2))
+           + (1.0 / b1) * (x - x0) * (x - x2) / (((double)x1 - x0) * ((double)x1 - x2))
+           + (1.0 / b2) * (x - x0) * (x - x1) / (((double)x2 - x0) * ((double)x2 - x1));
+    };
+
+    maxBatch = b0;
+    size_t searched = 0;
+    for(auto length : steps) {
+      if(length == x0 || length == x1 || length == x2) {
+        maxBatch = length == x0 ? b0 : length == x1 ? b1 : b2;
+        continue;
+      }
+      double inverse = inverseBatch((double)length);
+      size_t predicted = inverse > 0 ? (size_t)(1.0 / inverse) : maxBatch;
+      predicted = std::max((size_t)1, std::min(predicted, maxBatch));
+      if(probe(length, predicted)) {
+        maxBatch = predicted;
+      } else {
+        maxBatch = predicted > 2 ? search(length, predicted - 1) : 1;
+        searched++;
+      }
+    }
+    LOG(info,
+        "[batching] Extrapolated batch sizes for {} lengths, {} of them needed a search",
+        steps.size() - 3,
+        searched);
+
     return stats;
   }
 };
@@ -125,6 +235,8 @@ protected:
   /** Graphs of clients. One entry per GPU on this node. */
   std::vector<Ptr<ExpressionGraph>> clientGraphs_; // [num local GPUs]
 
+  bool isMainProcess() const override { return mpi_->myMPIRank() == 0; }
+
 public:
   MultiNodeGraphGroupBase(Ptr<Options> options)
     : Base(options) {
@@ -7,12 +7,23 @@ namespace marian {
 
 AsyncGraphGroup::AsyncGraphGroup(Ptr<Options> config)
     : GraphGroup(config),
-      ExponentialSmoothing{options_->get<float>("exponential-smoothing")},
+      ExponentialSmoothing{options_->get<float>("exponential-smoothing"),
+                           options_->get<bool>("exponential-smoothing-fused", false)},
       devices_{Config::getDevices(options_)},
       shardSync_(devices_.size()),
+      shardVersion_(devices_.size()),
+      shardCounters_(devices_.size()),
       optimizerDelay_{options_->get<size_t>("optimizer-delay")} {
   pool_.reset(new ThreadPool(devices_.size(), devices_.size()));
 
+  auto shardSync = options_->get<std::string>("async-shard-sync", "mutex");
+  if(shardSync == "seqlock")
+    shardSyncMode_ = ShardSync::seqlock;
+  else if(shardSync == "hogwild")
+    shardSyncMode_ = ShardSync::hogwild;
+  else
+    ABORT_IF(shardSync != "mutex", "Unknown shard synchronization '{}'", shardSync);
+
   for(auto device : devices_) {
     auto graph = New<ExpressionGraph>();
     graph->setDevice(device);
@@ -34,19 +45,73 @@ void AsyncGraphGroup::setScheduler(Ptr<Scheduler> scheduler) {
     scheduler_->registerTrainingObserver(opt);
 }
 
+std::unique_lock<std::mutex> AsyncGraphGroup::lockShard(size_t idx) {
+  std::unique_lock<std::mutex> lock(shardSync_[idx], std::try_to_lock);
+  if(!lock.owns_lock()) {
+    shardCounters_[idx].lockWaits++;
+    lock.lock();
+  }
+  return lock;
+}
+
+void AsyncGraphGroup::readShard(size_t idx, const std::function<void()>& copy) {
+  shardCounters_[idx].fetches++;
+  if(shardSyncMode_ == ShardSync::mutex) {
+    auto lock = lockShard(idx);
+    copy();
+  } else if(shardSyncMode_ == ShardSync::hogwild) {
+    copy();
+  } else {
+    auto& version = shardVersion_[idx];
+    for(;;) {
+      size_t before = version.load(std::memory_order_acquire);
+      if(before % 2 == 0) {
+        copy();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(version.load(std::memory_order_relaxed) == before)
+          return;
+      }
+      shardCounters_[idx].readRetries++;
+      std::this_thread::yield();
+    }
+  }
+}
+
+void AsyncGraphGroup::writeShard(size_t idx, const std::function<void()>& update) {
+  shardCounters_[idx].pushes++;
+  auto lock = lockShard(idx);
+  auto& version = shardVersion_[idx];
+  version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  update();
+  version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void AsyncGraphGroup::logShardCounters() {
+  for(size_t idx = 0; idx < shardCounters_.size(); ++idx) {
+    auto& c = shardCounters_[idx];
+    LOG(info,
+        "[async] Shard {}: {} fetches, {} pushes, {} waits for lock, {} seqlock read retries",
+        idx,
+        c.fetches.load(),
+        c.pushes.load(),
+        c.lockWaits.load(),
+        c.readRetries.load());
+  }
+}
+
 void AsyncGraphGroup::fetchParams(Tensor oldParams,
                                   const std::vector<Tensor>& params,
                                   int /*device_id*/) {
-  // @TODO read guard on parameters
   int pos = 0;
 
   std::vector<std::thread> threads;
   for(int idx = 0; idx < devices_.size(); idx++) {
     threads.emplace_back(std::thread(
         [&](int idx, int pos) {
-          // individual mutex per-shard
-          std::lock_guard<std::mutex> guard(shardSync_[idx]);
-          oldParams->subtensor((int)pos, (int)params[idx]->size())->copyFrom(params[idx]);
+          readShard(idx, [&]() {
+            oldParams->subtensor((int)pos, (int)params[idx]->size())->copyFrom(params[idx]);
+          });
         },
         idx,
         pos));
@@ -66,15 +131,15 @@ void AsyncGraphGroup::pushGradients(Tensor newGrads,
   for(int idx = 0; idx < devices_.size(); idx++) {
     threads.emplace_back(std::thread(
         [&](int idx, int pos) {
-          // individual mutex per-shard
-          std::lock_guard<std::mutex> guard(shardSync_[idx]);
-          grads_[idx]->copyFrom(newGrads->subtensor(pos, (int)grads_[idx]->size()));
-
-          shardOpt_[idx]->update(params_[idx], grads_[idx]);
-
-          if(mvAvg_)
-            updateAvgParams(
-                paramsAvg_[idx], params_[idx], scheduler_->numberOfBatches());
+          writeShard(idx, [&]() {
+            grads_[idx]->copyFrom(newGrads->subtensor(pos, (int)grads_[idx]->size()));
+
+            updateParams(shardOpt_[idx],
+                         params_[idx],
+                         grads_[idx],
+                         mvAvg_ ? paramsAvg_[idx] : nullptr,
+                         mvAvg_ ? scheduler_->numberOfBatches() : 0);
+          });
         },
         idx,
         pos));
@@ -399,6 +464,7 @@ void AsyncGraphGroup::save(Ptr<ExpressionGraph> graph, bool final /*=false*/) {
 void AsyncGraphGroup::finalize() {
   pool_->join_all();  // call before destructing thread pool
   pool_.reset(nullptr);
+  logShardCounters();
   finalized_ = true;
 }
 
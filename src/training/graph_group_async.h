@@ -4,6 +4,8 @@
 #include "training/exponential_smoothing.h"
 #include "training/graph_group.h"
 
+#include <atomic>
+#include <functional>
 #include <future>
 #include <thread>
 
@@ -23,6 +25,30 @@ protected:
   std::mutex sync_;
   std::vector<std::mutex> shardSync_;
 
+  // How workers synchronize on parameter shards. Updates of a shard are always
+  // serialized by its mutex as the optimizer keeps per-shard state. With
+  // seqlock, fetching a shard does not lock but retries the copy if the
+  // shard's sequence number shows that an update was running meanwhile; with
+  // hogwild, fetching never locks nor retries and may see partial updates.
+  enum class ShardSync { mutex, seqlock, hogwild };
+  ShardSync shardSyncMode_{ShardSync::mutex};
+
+  // Even while a shard is stable, odd while it is being updated
+  std::vector<std::atomic<size_t>> shardVersion_;
+
+  struct ShardCounters {
+    std::atomic<size_t> fetches{0};
+    std::atomic<size_t> pushes{0};
+    std::atomic<size_t> lockWaits{0};    // lock was held by another thread
+    std::atomic<size_t> readRetries{0};  // seqlock copies repeated or delayed
+  };
+  std::vector<ShardCounters> shardCounters_;
+
+  std::unique_lock<std::mutex> lockShard(size_t idx);
+  void readShard(size_t idx, const std::function<void()>& copy);
+  void writeShard(size_t idx, const std::function<void()>& update);
+  void logShardCounters();
+
   std::mutex schedulerMutex_;
 
   std::vector<Tensor> params_;
@@ -25,13 +25,12 @@ void AsyncGraphGroupDrop::fetchParams(Tensor oldParams,
           auto sparseGrad = sparseGrads_[device_id][idx];
           auto sparseShard = sparseShards_[device_id][idx];
 
-          // individual mutex per-shard
-          std::lock_guard<std::mutex> guard(shardSync_[idx]);
-
-          sparseShard->gather(params[idx]);
-          sparseGrad->copyFrom(sparseShard);
-          sparseGrad->scatterUpdate(
-              oldParams->subtensor((int)pos, (int)params[idx]->size()));
+          readShard(idx, [&]() {
+            sparseShard->gather(params[idx]);
+            sparseGrad->copyFrom(sparseShard);
+            sparseGrad->scatterUpdate(
+                oldParams->subtensor((int)pos, (int)params[idx]->size()));
+          });
         },
         idx,
         pos));
@@ -59,27 +58,26 @@ void AsyncGraphGroupDrop::pushGradients(Tensor newGrads,
           auto sparseGrad = sparseGrads_[device_id][idx];
           auto sparseShard = sparseShards_[device_id][idx];
           auto tensor = newGrads->subtensor((int)pos, (int)grads_[idx]->size());
-          // individual mutex per-shard
-          std::lock_guard<std::mutex> guard(shardSync_[idx]);
-
-          // drop the gradients
-          dropper->dropGraph(
-              tensor, sparseGrad, droping_rate, dropping_momentum);
-
-          // send the sharded sparse tensor
-          sparseShard->copyFrom(sparseGrad);
-
-          // convert back to dense, store it in grads_[idx]
-          // sparseShard indices is equal to the indices of the sparse gradient
-          // which will be used for sparse fetching
-          sparseShard->toDense(grads_[idx]);
-
-          // optimize
-          shardOpt_[idx]->update(params_[idx], grads_[idx]);
-
-          if(mvAvg_)
-            updateAvgParams(
-                paramsAvg_[idx], params_[idx], scheduler_->numberOfBatches());
+          writeShard(idx, [&]() {
+            // drop the gradients
+            dropper->dropGraph(
+                tensor, sparseGrad, droping_rate, dropping_momentum);
+
+            // send the sharded sparse tensor
+            sparseShard->copyFrom(sparseGrad);
+
+            // convert back to dense, store it in grads_[idx]
+            // sparseShard indices is equal to the indices of the sparse gradient
+            // which will be used for sparse fetching
+            sparseShard->toDense(grads_[idx]);
+
+            // optimize
+            updateParams(shardOpt_[idx],
+                         params_[idx],
+                         grads_[idx],
+                         mvAvg_ ? paramsAvg_[idx] : nullptr,
+                         mvAvg_ ? scheduler_->numberOfBatches() : 0);
+          });
         },
         idx,
         pos));
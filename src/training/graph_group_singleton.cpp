@@ -16,21 +16,23 @@ void SingletonGraph::execute(Ptr<data::Batch> batch) {
   float cost = costNode->scalar();
   graph_->backward();
 
-  // Get batch stats
-  opt_->update(graph_);
-
   if(mvAvg_) {
     ABORT_IF(!scheduler_, "Scheduler is required for exponential smoothing");
 
     if(!graphAvg_) {
+      opt_->update(graph_);
       graphAvg_ = New<ExpressionGraph>();
       graphAvg_->setDevice(graph_->getDeviceId());
       graphAvg_->copyParams(graph_);
     } else {
-      updateAvgParams(graphAvg_->params()->vals(),
-                      graph_->params()->vals(),
-                      scheduler_->numberOfBatches());
+      updateParams(opt_,
+                   graph_->params()->vals(),
+                   graph_->params()->grads(),
+                   graphAvg_->params()->vals(),
+                   scheduler_->numberOfBatches());
     }
+  } else {
+    opt_->update(graph_);
   }
 
   if(scheduler_) {
@@ -25,7 +25,8 @@ private:
 public:
   SingletonGraph(Ptr<Options> config)
       : GraphGroup(config),
-        ExponentialSmoothing(options_->get<float>("exponential-smoothing")) {
+        ExponentialSmoothing(options_->get<float>("exponential-smoothing"),
+                             options_->get<bool>("exponential-smoothing-fused", false)) {
     // Get device ID
     auto devices = Config::getDevices(options_);
     ABORT_IF(devices.size() != 1, "Only one device ID should be provided for singleton training");
@@ -1,10 +1,13 @@
 #include "training/graph_group_sync.h"
 
+#include <cstdio>
+
 namespace marian {
 
 SyncGraphGroup::SyncGraphGroup(Ptr<Options> config)
     : GraphGroup(config),
-      ExponentialSmoothing{options_->get<float>("exponential-smoothing")},
+      ExponentialSmoothing{options_->get<float>("exponential-smoothing"),
+                           options_->get<bool>("exponential-smoothing-fused", false)},
       delay_{options_->get<size_t>("optimizer-delay")} { // @TODO: rename to something else; delay means delayed updated, not accumulation
 
   mpi_ = initMPI(/*multiThreaded=*/false); // when not running under MPI, this will be a fake object that represents a one-MPI-process setup
@@ -25,6 +28,9 @@ SyncGraphGroup::SyncGraphGroup(Ptr<Options> config)
   // This part of the code will not special-case any of this here.
   // Rather, it is assumed that the communicator knows to reduce unnecessary transfers to no-ops.
   comm_ = createCommunicator(graphs_, /*noNccl=*/options_->get<bool>("no-nccl", false), /*mpi=*/mpi_);
+
+  if(options_->get<bool>("async-save", false))
+    asyncWriter_.reset(new io::AsyncWriter());
 }
 
 void SyncGraphGroup::setScheduler(Ptr<Scheduler> scheduler) /*override*/ {
@@ -132,6 +138,11 @@ void SyncGraphGroup::update(Ptr<data::Batch> batch) /*override*/ {
     first_ = false;
   }
 
+  // With --gradient-bucket-size, gradients are reduced in buckets while the last backward step
+  // is still running, as soon as all devices have finished a bucket.
+  size_t bucketSize = options_->get<size_t>("gradient-bucket-size", 0) * 1024 * 1024 / sizeof(float);
+  bool overlap = bucketSize > 0 && comm_->canOverlapScatterReduce();
+
   // Compute gradients
   // This happens in multiple steps in case of delay_ > 1.
   std::vector<float> localDeviceCosts(devices_.size(), 0.f); // [local device index] aggregate cost for each local device
@@ -141,6 +152,11 @@ void SyncGraphGroup::update(Ptr<data::Batch> batch) /*override*/ {
       auto graph = graphs_[localDeviceIndex];
       auto subBatch = getSubBatch(t, localDeviceIndex, mpi_->myMPIRank());
 
+      if(overlap && t == delay_ - 1) // gradients are final only after the last delay step
+        graph->setGradientsReadyCallback(bucketSize, [&, localDeviceIndex](size_t begin, size_t end) {
+          comm_->gradientsReady(localDeviceIndex, begin, end);
+        });
+
       if(subBatch) {
         timer::Timer timer;
         auto costNode = builders_[localDeviceIndex]->build(graph, subBatch);
@@ -157,6 +173,8 @@ void SyncGraphGroup::update(Ptr<data::Batch> batch) /*override*/ {
         graph->forward();
         graph->backward(/*zero=*/t == 0);
       }
+
+      graph->setGradientsReadyCallback(0, nullptr);
     };
 
     comm_->foreach(forwardBackward); // compute gradients in parallel on each device. Aggregate if delay_ > 1.
@@ -178,15 +196,18 @@ void SyncGraphGroup::update(Ptr<data::Batch> batch) /*override*/ {
     }
 
     // actual model update
-    shardOpt_[idx]->update(curParam, curGrad);
-
-    if(mvAvg_)
-      updateAvgParams(
-          paramsAvg_[idx], curParam, scheduler_->numberOfBatches());
+    updateParams(shardOpt_[idx],
+                 curParam,
+                 curGrad,
+                 mvAvg_ ? paramsAvg_[idx] : nullptr,
+                 mvAvg_ ? scheduler_->numberOfBatches() : 0);
   };
 
   timer::Timer timer;
-  comm_->scatterReduce(); // reduce gradients across all devices (globally) into shards
+  if(overlap)
+    comm_->finishScatterReduce(); // wait for reductions started during backward
+  else
+    comm_->scatterReduce(); // reduce gradients across all devices (globally) into shards
   //LOG(info, timer.format(2, "after scatterReduce (has sync): %ws"));
   comm_->foreach(update); // per-shard model-update
   //LOG(info, timer.format(2, "after model update (no sync): %ws"));
@@ -267,6 +288,14 @@ void SyncGraphGroup::load() /*override*/ {
 }
 
 void SyncGraphGroup::save(bool final) /*override*/ {
+  // With --async-save, only the copies of parameters and optimizer state to the CPU happen here,
+  // while the files are written on a background thread. There is at most one checkpoint in
+  // flight, and the final one is written synchronously.
+  if(asyncWriter_)
+    asyncWriter_->wait();
+  bool async = asyncWriter_ && !final;
+  UPtr<io::AsyncWriter::Scope> asyncScope(async ? new io::AsyncWriter::Scope(*asyncWriter_) : nullptr);
+
   barrier(); // (for better grouping of log messages)
   //LOG(info, "[{}] save() line {}!", this->mpi_->idStr(), __LINE__);
   // do final validation
@@ -318,8 +347,10 @@ void SyncGraphGroup::save(bool final) /*override*/ {
     builders_[0]->save(graphs_[0], name, true);
     //LOG(info, "[{}] save() line {}", this->mpi_->idStr(), __LINE__);
     // save scheduler-related state
+    // In async mode, it is snapshotted into temporary files that are moved into place after all
+    // model and optimizer files, so that a restart never sees progress ahead of the parameters.
     if (scheduler_)
-      scheduler_->save(name);
+      scheduler_->save(async ? name + ".tmp" : name);
     //LOG(info, "[{}] save() line {}", this->mpi_->idStr(), __LINE__);
   }
 
@@ -345,6 +376,18 @@ void SyncGraphGroup::save(bool final) /*override*/ {
     isMainProcess());
   //LOG(info, "[{}] save() line {}", this->mpi_->idStr(), __LINE__);
 
+  if(async && scheduler_ && isMainProcess()) {
+    asyncWriter_->enqueue([name]() {
+      for(std::string suffix : {".yml", ".progress.yml"}) {
+        std::string tmpName = name + ".tmp" + suffix;
+        ABORT_IF(std::rename(tmpName.c_str(), (name + suffix).c_str()) != 0,
+                 "Could not rename {} to {}",
+                 tmpName,
+                 name + suffix);
+      }
+    });
+  }
+
   barrier(); // (for better grouping of log messages)
   //LOG(info, "[{}] save() line {}", this->mpi_->idStr(), __LINE__);
 }
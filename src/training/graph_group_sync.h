@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/io.h"
 #include "training/graph_group.h"
 #include "training/communicator.h"
 #include "training/exponential_smoothing.h"
@@ -25,10 +26,12 @@ class SyncGraphGroup : public GraphGroup, public ExponentialSmoothing {
 
   bool first_{ true }; // gets interpreted and cleared by update()
 
+  UPtr<io::AsyncWriter> asyncWriter_; // [null unless --async-save] writes checkpoints in the background
+
   void initialize(const Ptr<data::Batch>& exampleBatch);
   void initializeAvg();
 
-  bool isMainProcess() const { return mpi_->myMPIRank() == 0; } // (we need this test a few times)
+  bool isMainProcess() const override { return mpi_->myMPIRank() == 0; } // (we need this test a few times)
   void barrier() const { mpi_->barrier(); } // (we need this several times)
   void swapParamsAvg() { if (mvAvg_ && paramsAvg_.size() > 0) comm_->swapParams(paramsAvg_); } // note: must call this on all MPI ranks in parallel
 
@@ -2,6 +2,7 @@
 
 #include "common/config.h"
 #include "data/batch_generator.h"
+#include "data/corpus_binary.h"
 #ifndef _MSC_VER // @TODO: include SqLite in Visual Studio project
 #include "data/corpus_sqlite.h"
 #endif
@@ -23,7 +24,9 @@ public:
     using namespace data;
 
     Ptr<CorpusBase> dataset;
-    if(!options_->get<std::string>("sqlite").empty())
+    if(!options_->get<std::string>("binary-corpus").empty())
+      dataset = New<CorpusBinary>(options_);
+    else if(!options_->get<std::string>("sqlite").empty())
 #ifndef _MSC_VER // @TODO: include SqLite in Visual Studio project
       dataset = New<CorpusSQLite>(options_);
 #else
@@ -18,6 +18,18 @@ private:
   Word trgEosId_ = (Word)-1;
   Word trgUnkId_ = (Word)-1;
 
+  // Options used per hypothesis or per step, resolved once when the search is created. A search
+  // object lives for a single batch, so changes to the options are picked up by the next batch.
+  bool nBest_;
+  bool alignment_;
+  bool suppressUnk_;
+  float normalize_;
+  float wordPenalty_;
+  float maxLengthFactor_;
+
+  // owns all hypotheses created during search(), shared with the returned histories
+  Ptr<HypothesisArena> arena_;
+
 public:
   BeamSearch(Ptr<Options> options,
              const std::vector<Ptr<Scorer>>& scorers,
@@ -29,7 +41,13 @@ public:
                       ? options_->get<size_t>("beam-size")
                       : 3),
         trgEosId_(trgEosId),
-        trgUnkId_(trgUnkId) {}
+        trgUnkId_(trgUnkId),
+        nBest_(options_->get<bool>("n-best")),
+        alignment_(options_->has("alignment")),
+        suppressUnk_(options_->has("allow-unk") && !options_->get<bool>("allow-unk")),
+        normalize_(options_->get<float>("normalize")),
+        wordPenalty_(options_->get<float>("word-penalty")),
+        maxLengthFactor_(options_->get<float>("max-length-factor")) {}
 
   Beams toHyps(const std::vector<unsigned int> keys,
                const std::vector<float> pathScores,
@@ -42,7 +60,7 @@ public:
     Beams newBeams(beams.size());
 
     std::vector<float> align;
-    if(options_->has("alignment"))
+    if(alignment_)
       // Use alignments from the first scorer, even if ensemble
       align = scorers_[0]->getAlignment();
 
@@ -78,24 +96,26 @@ public:
         if(first)
           beamHypIdx = 0;
 
-        auto hyp = New<Hypothesis>(beam[beamHypIdx], embIdx, hypIdxTrans, pathScore);
+        auto prevHyp = beam[beamHypIdx];
+        auto hyp = arena_->newHypothesis(prevHyp, embIdx, hypIdxTrans, pathScore);
 
         // Set score breakdown for n-best lists
-        if(options_->get<bool>("n-best")) {
-          std::vector<float> breakDown(states.size(), 0);
-          beam[beamHypIdx]->GetScoreBreakdown().resize(states.size(), 0);
+        if(nBest_) {
+          // the initial hypothesis has no breakdown, which counts as all zeros
+          const auto& prevBreakDown = prevHyp->GetScoreBreakdown();
+          float* breakDown = arena_->allocateFloats(states.size());
           for(size_t j = 0; j < states.size(); ++j) {
             size_t key = embIdx + hypIdxTrans * vocabSize;
             breakDown[j] = states[j]->breakDown(key)
-                           + beam[beamHypIdx]->GetScoreBreakdown()[j];
+                           + (j < prevBreakDown.size() ? prevBreakDown[j] : 0.f);
           }
-          hyp->GetScoreBreakdown() = breakDown;
+          hyp->SetScoreBreakdown(FloatSpan(breakDown, states.size()));
         }
 
         // Set alignments
         if(!align.empty()) {
-          hyp->SetAlignment(
-              getAlignmentsForHypothesis(align, batch, (int)beamHypIdx, (int)beamIdx));
+          hyp->SetAlignment(arena_->copyFloats(
+              getAlignmentsForHypothesis(align, batch, (int)beamHypIdx, (int)beamIdx)));
         }
 
         newBeam.push_back(hyp);
@@ -158,12 +178,12 @@ public:
   Histories search(Ptr<ExpressionGraph> graph, Ptr<data::CorpusBatch> batch) {
     int dimBatch = (int)batch->size();
 
+    arena_ = New<HypothesisArena>();
+
     Histories histories;
     for(int i = 0; i < dimBatch; ++i) {
       size_t sentId = batch->getSentenceIds()[i];
-      auto history = New<History>(sentId,
-                                  options_->get<float>("normalize"),
-                                  options_->get<float>("word-penalty"));
+      auto history = New<History>(sentId, arena_, normalize_, wordPenalty_);
       histories.push_back(history);
     }
 
@@ -173,7 +193,7 @@ public:
 
     Beams beams(dimBatch);        // [batchIndex][beamIndex] is one sentence hypothesis
     for(auto& beam : beams)
-      beam.resize(localBeamSize, New<Hypothesis>());
+      beam.resize(localBeamSize, arena_->newHypothesis());
 
     bool first = true;
     bool final = false;
@@ -252,8 +272,7 @@ public:
 
       //**********************************************************************
       // suppress specific symbols if not at right positions
-      if(trgUnkId_ != -1 && options_->has("allow-unk")
-         && !options_->get<bool>("allow-unk"))
+      if(trgUnkId_ != -1 && suppressUnk_)
         suppressWord(pathScores, trgUnkId_);
       for(auto state : states)
         state->blacklist(pathScores, batch);
@@ -281,8 +300,7 @@ public:
         if(!beams[i].empty()) {
           final = final
                   || histories[i]->size()
-                         >= options_->get<float>("max-length-factor")
-                                * batch->front()->batchWidth();
+                         >= maxLengthFactor_ * batch->front()->batchWidth();
           histories[i]->Add(
               beams[i], trgEosId_, prunedBeams[i].empty() || final);
         }
@@ -20,7 +20,7 @@ private:
   };
 
 public:
-  History(size_t lineNo, float alpha = 1.f, float wp_ = 0.f);
+  History(size_t lineNo, Ptr<HypothesisArena> arena, float alpha = 1.f, float wp_ = 0.f);
 
   float LengthPenalty(size_t length) { return std::pow((float)length, alpha_); }
   float WordPenalty(size_t length) { return wp_ * (float)length; }
@@ -48,7 +48,8 @@ public:
 
       const size_t start = bestHypCoord.i; // last time step of this hypothesis
       const size_t j     = bestHypCoord.j; // which beam entry
-      Ptr<Hypothesis> bestHyp = history_[start][j];
+      // aliases the arena, which keeps the hypothesis and its predecessors alive
+      Ptr<Hypothesis> bestHyp(arena_, history_[start][j]);
       // float c = bestHypCoord.normalizedPathScore;
       // std::cerr << "h: " << start << " " << j << " " << c << std::endl;
 
@@ -67,6 +68,7 @@ public:
 
 private:
   std::vector<Beam> history_; // [time step][index into beam] search grid
+  Ptr<HypothesisArena> arena_; // owns all hypotheses in history_
   std::priority_queue<SentenceHypothesisCoord> topHyps_; // all sentence hypotheses (those that reached eos), sorted by score
   size_t lineNo_;
   float alpha_;
@@ -1,22 +1,44 @@
 #pragma once
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "common/definitions.h"
 #include "data/alignment.h"
 
 namespace marian {
 
+/**
+ * Non-owning view of a sequence of floats stored in a HypothesisArena, used for score
+ * breakdowns and soft alignments of hypotheses.
+ */
+class FloatSpan {
+public:
+  FloatSpan() {}
+  FloatSpan(const float* data, size_t size) : data_(data), size_(size) {}
+
+  const float* begin() const { return data_; }
+  const float* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  float operator[](size_t i) const { return data_[i]; }
+
+private:
+  const float* data_{nullptr};
+  size_t size_{0};
+};
+
 class Hypothesis {
 public:
   Hypothesis() : prevHyp_(nullptr), prevIndex_(0), word_(0), pathScore_(0.0) {}
 
-  Hypothesis(const Ptr<Hypothesis> prevHyp,
+  Hypothesis(const Hypothesis* prevHyp,
              Word word,
              IndexType prevIndex,
              float pathScore)
       : prevHyp_(prevHyp), prevIndex_(prevIndex), word_(word), pathScore_(pathScore) {}
 
-  const Ptr<Hypothesis> GetPrevHyp() const { return prevHyp_; }
+  const Hypothesis* GetPrevHyp() const { return prevHyp_; }
 
   Word GetWord() const { return word_; }
 
@@ -24,16 +46,18 @@ public:
 
   float GetPathScore() const { return pathScore_; }
 
-  std::vector<float>& GetScoreBreakdown() { return scoreBreakdown_; }
-  std::vector<float>& GetAlignment() { return alignment_; }
+  const FloatSpan& GetScoreBreakdown() const { return scoreBreakdown_; }
+  const FloatSpan& GetAlignment() const { return alignment_; }
 
-  void SetAlignment(const std::vector<float>& align) { alignment_ = align; };
+  // spans are allocated from the arena that owns this hypothesis
+  void SetScoreBreakdown(const FloatSpan& breakDown) { scoreBreakdown_ = breakDown; }
+  void SetAlignment(const FloatSpan& align) { alignment_ = align; };
 
   // helpers to trace back paths referenced from this hypothesis
-  Words TracebackWords()
+  Words TracebackWords() const
   {
       Words targetWords;
-      for (auto hyp = this; hyp->GetPrevHyp(); hyp = hyp->GetPrevHyp().get()) {
+      for (auto hyp = this; hyp->GetPrevHyp(); hyp = hyp->GetPrevHyp()) {
           targetWords.push_back(hyp->GetWord());
           // std::cerr << hyp->GetWord() << " " << hyp << std::endl;
       }
@@ -43,27 +67,83 @@ public:
 
   // get soft alignments for each target word starting from the hyp one
   typedef data::SoftAlignment SoftAlignment;
-  SoftAlignment TracebackAlignment()
+  SoftAlignment TracebackAlignment() const
   {
       SoftAlignment align;
-      for (auto hyp = this; hyp->GetPrevHyp(); hyp = hyp->GetPrevHyp().get()) {
-          align.push_back(hyp->GetAlignment());
+      for (auto hyp = this; hyp->GetPrevHyp(); hyp = hyp->GetPrevHyp()) {
+          align.emplace_back(hyp->GetAlignment().begin(), hyp->GetAlignment().end());
       }
       std::reverse(align.begin(), align.end());
       return align;
   }
 
 private:
-  const Ptr<Hypothesis> prevHyp_;
-  const IndexType prevIndex_;
-  const Word word_;
-  const float pathScore_;
+  const Hypothesis* prevHyp_;
+  IndexType prevIndex_;
+  Word word_;
+  float pathScore_;
+
+  FloatSpan scoreBreakdown_;
+  FloatSpan alignment_;
+};
+
+/**
+ * Search-scoped storage for hypotheses and their score breakdowns and alignments.
+ *
+ * Beam search creates beam size many hypotheses per sentence and step, all of which are kept
+ * alive until the search is over for traceback. Instead of one heap allocation (plus a
+ * shared_ptr control block and vectors) per hypothesis, they are placed into large blocks that
+ * are released all at once together with the arena. Blocks never move, so hypotheses and spans
+ * can reference each other with plain pointers.
+ */
+class HypothesisArena {
+public:
+  HypothesisArena(size_t hypsPerBlock = 4096, size_t floatsPerBlock = 65536)
+      : hypsPerBlock_(hypsPerBlock), floatsPerBlock_(floatsPerBlock) {}
+
+  template <typename... Args>
+  Hypothesis* newHypothesis(Args&&... args) {
+    if(hypBlocks_.empty() || hypsUsed_ == hypsPerBlock_) {
+      hypBlocks_.emplace_back(new Hypothesis[hypsPerBlock_]);
+      hypsUsed_ = 0;
+    }
+    Hypothesis* hyp = hypBlocks_.back().get() + hypsUsed_++;
+    *hyp = Hypothesis(std::forward<Args>(args)...);
+    return hyp;
+  }
+
+  // returns a zero-initialized span of n floats
+  float* allocateFloats(size_t n) {
+    if(floatBlocks_.empty() || floatsUsed_ + n > floatsCapacity_) {
+      floatsCapacity_ = std::max(n, floatsPerBlock_);
+      floatBlocks_.emplace_back(new float[floatsCapacity_]);
+      floatsUsed_ = 0;
+    }
+    float* data = floatBlocks_.back().get() + floatsUsed_;
+    floatsUsed_ += n;
+    std::fill(data, data + n, 0.f);
+    return data;
+  }
+
+  FloatSpan copyFloats(const std::vector<float>& values) {
+    float* data = allocateFloats(values.size());
+    std::copy(values.begin(), values.end(), data);
+    return FloatSpan(data, values.size());
+  }
+
+private:
+  size_t hypsPerBlock_;
+  size_t floatsPerBlock_;
+
+  std::vector<UPtr<Hypothesis[]>> hypBlocks_;
+  size_t hypsUsed_{0};
 
-  std::vector<float> scoreBreakdown_;
-  std::vector<float> alignment_;
+  std::vector<UPtr<float[]>> floatBlocks_;
+  size_t floatsUsed_{0};
+  size_t floatsCapacity_{0};
 };
 
-typedef std::vector<Ptr<Hypothesis>> Beam;                // Beam = vector of hypotheses
+typedef std::vector<Hypothesis*> Beam;                    // Beam = vector of hypotheses, owned by a HypothesisArena
 typedef std::vector<Beam> Beams;                          // Beams = vector of vector of hypotheses
 typedef std::tuple<Words, Ptr<Hypothesis>, float> Result; // (word ids for hyp, hyp, normalized sentence score for hyp)
 typedef std::vector<Result> NBestList;                    // sorted vector of (word ids, hyp, sent score) tuples
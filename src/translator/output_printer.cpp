@@ -3,16 +3,8 @@
 namespace marian {
 
 std::string OutputPrinter::getAlignment(const Ptr<Hypothesis>& hyp) {
-  data::SoftAlignment align;
-  auto last = hyp;
-  // get soft alignments for each target word starting from the last one
-  while(last->GetPrevHyp().get() != nullptr) {
-    align.push_back(last->GetAlignment());
-    last = last->GetPrevHyp();
-  }
-
-  // reverse alignments
-  std::reverse(align.begin(), align.end());
+  // get soft alignments for each target word
+  data::SoftAlignment align = hyp->TracebackAlignment();
 
   if(alignment_ == "soft") {
     return data::SoftAlignToString(align);